@@ -29,6 +29,8 @@ struct qpainter_t
   qbounds_t                             boundary;
   qbounds_t                             maxBounds;
   char *                                pClearBrush;
+  qcoord_t                              origin;         // Added to every coordinate painted.
+  qregion_t                             clip;           // In screen coordinates.
 };
 
 #endif // QPAINTER_INL
\ No newline at end of file
@@ -15,6 +15,8 @@
  ******************************************************************************/
 
 #include "qapplication.h"
+#include "qshortcut_map.h"
+#include "qspatial_index.h"
 #include "detail/qpainter.inl"
 #include <ncurses.h>
 #include <ctype.h>
@@ -29,6 +31,9 @@ extern "C" {
 // Application Implementations
 ////////////////////////////////////////////////////////////////////////////////
 
+// How often input waits are interrupted while background work is running.
+#define QAPPLICATION_POLL_MS            50
+
 //------------------------------------------------------------------------------
 QPIMPL_STRUCT(qapplication_t) {
   qbool_t                               isQuitting;
@@ -36,6 +41,14 @@ QPIMPL_STRUCT(qapplication_t) {
   qbool_t                               hasColors;
   qbool_t                               canChangeColors;
   qcoord_t                              mouseCoord;
+  qcoord_t                              localMouseCoord;
+  qwidget_t *                           pHoverWidget;
+  qwidget_t *                           pFocusWidget;
+  qwidget_t *                           pFocusFirst;    // Head of the tab order ring.
+  uint32_t                              focusGeneration;
+  qkey_event_t                          keyEvent;
+  qspatial_index_t *                    pSpatialIndex;
+  qshortcut_map_t *                     pShortcuts;
   mmask_t                               mouseEvents;
   qregion_t                             screenRegion;
   qmouse_t                              stickyMouseState;
@@ -45,6 +58,15 @@ QPIMPL_STRUCT(qapplication_t) {
   qstatus_bar_t *                       pStatusBar;     // TODO: Implement.
 };
 
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(quit, int);
+QDEFINE_EMITTER(resize, qbounds_t const *);
+QDEFINE_EMITTER(on_key, qkey_t, int);
+QDEFINE_EMITTER(on_mouse, qcoord_t const *, qmouse_t);
+QDEFINE_EMITTER(on_hover, qbool_t);
+QDEFINE_EMITTER(on_key_press, qkey_event_t *);
+QDEFINE_EMITTER(on_focus, qbool_t);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Application Callbacks
 ////////////////////////////////////////////////////////////////////////////////
@@ -57,9 +79,13 @@ QRECALC(
 ) {
   int err;
   char * pNewBuffer;
+  qbool_t resized;
 
   // Update the application's painter instance.
+  resized = !qregion_equal(&QW(pThis)->outerRegion, pRegion);
   QP(pThis)->painter.boundary = pRegion->bounds;
+  QP(pThis)->painter.origin = qcoord(0, 0);
+  QP(pThis)->painter.clip = *pRegion;
   if (QP(pThis)->painter.maxBounds.columns < pRegion->bounds.columns) {
     pNewBuffer = qreallocate(
       QW(pThis)->pAllocator,
@@ -90,13 +116,28 @@ QRECALC(
 
   // The central widget should fill the remaining space that menu/status aren't filling.
   // TODO: Right now, menu_bar and status_bar aren't implemented - so same as pRegion.
-  if (qwidget_check(QP(pThis)->pMainWidget)) {
+  // Note: Without a resize, a clean main widget has nothing below it to recalculate.
+  if (qwidget_check(QP(pThis)->pMainWidget) && (resized || qwidget_is_dirty(QP(pThis)->pMainWidget))) {
     err = qwidget_recalculate(QP(pThis)->pMainWidget, pRegion);
     if (err) {
       return err;
     }
   }
 
+  // With the geometry settled, refresh the regions used to route mouse events.
+  return qspatial_index_update(QP(pThis)->pSpatialIndex, pThis, &pRegion->bounds);
+}
+
+//------------------------------------------------------------------------------
+QVISIT(
+  qapplication_visit,
+  qapplication_t *                      pThis,
+  qwidget_visitor_pfn                   pfnVisitor,
+  void *                                pUserData
+) {
+  if (QP(pThis)->pMainWidget) {
+    return pfnVisitor(QP(pThis)->pMainWidget, pUserData);
+  }
   return 0;
 }
 
@@ -148,8 +189,8 @@ static int qapplication_update_resize (
   // We have valid values, let's cast to the correct integral types.
   resize.coord.column   = 0;
   resize.coord.row      = 0;
-  resize.bounds.columns = (size_t)x;
-  resize.bounds.rows    = (size_t)y;
+  resize.bounds.columns = (qextent_t)x;
+  resize.bounds.rows    = (qextent_t)y;
 
   // If they haven't changed from our previous x/y, nothing to do.
   qbool_t const screenSizeChanged = QBOOL(
@@ -163,17 +204,109 @@ static int qapplication_update_resize (
   // Update the last-known application screen sizes.
   // TODO: Really, find out what to do about this resize/recalculate thing.
   //       Maybe this needs to be sketched out and designed, this is annoying.
+  // Note: Emit the stored bounds, the local region won't outlive a queued delivery.
   QP(pApplication)->screenRegion = resize;
   qwidget_mark_dirty(pApplication);
-  qwidget_emit(pApplication, resize, &resize.bounds);
+  return qwidget_emit(pApplication, resize, &QP(pApplication)->screenRegion.bounds);
+}
 
-  return 0;
+// Note: Only the topmost widget under the cursor receives the event (in local coordinates).
+//       The coordinates are stored in the application so that queued slots may read them.
+//------------------------------------------------------------------------------
+static int qapplication_route_mouse (
+  qapplication_t *                      pApplication,
+  qmouse_t                              mouseState
+) {
+  int err;
+  int result;
+  qcoord_t origin;
+  qwidget_t * pTarget;
+  qwidget_t * pHover;
+
+  // Find the topmost widget, and transition the hover state if it changed.
+  // A hovered widget which has since been hidden is not told that it was left.
+  result = 0;
+  pTarget = qspatial_index_hit_test(QP(pApplication)->pSpatialIndex, &QP(pApplication)->mouseCoord);
+  pHover = QP(pApplication)->pHoverWidget;
+  if (pTarget != pHover) {
+    QP(pApplication)->pHoverWidget = pTarget;
+    if (pHover && qspatial_index_contains(QP(pApplication)->pSpatialIndex, pHover)) {
+      err = qwidget_emit(pHover, on_hover, QFALSE);
+      if (err && !result) {
+        result = err;
+      }
+    }
+    if (pTarget) {
+      err = qwidget_emit(pTarget, on_hover, QTRUE);
+      if (err && !result) {
+        result = err;
+      }
+    }
+  }
+  if (!pTarget) {
+    return result;
+  }
+
+  // Emit the mouse event relative to the target's outer region (as shown on screen).
+  origin = qspatial_index_origin(QP(pApplication)->pSpatialIndex, pTarget);
+  QP(pApplication)->localMouseCoord = qcoord(
+    QP(pApplication)->mouseCoord.column - origin.column,
+    QP(pApplication)->mouseCoord.row    - origin.row
+  );
+  err = qwidget_emit(
+    pTarget,
+    on_mouse,
+    &QP(pApplication)->localMouseCoord,
+    mouseState
+  );
+  if (err && !result) {
+    result = err;
+  }
+
+  return result;
+}
+
+// Note: Called for every widget destroyed, input may arrive before the next recalculate notices.
+//------------------------------------------------------------------------------
+static void QCURSESCALL qapplication_forget_widget (
+  qwidget_t *                           pWidget,
+  void *                                pUserData
+) {
+  qapplication_t * pApplication;
+
+  pApplication = (qapplication_t *)pUserData;
+  if (QP(pApplication)->pHoverWidget == pWidget) {
+    QP(pApplication)->pHoverWidget = NULL;
+  }
+  if (QP(pApplication)->pFocusWidget == pWidget) {
+    QP(pApplication)->pFocusWidget = NULL;
+  }
+
+  // The ring is rebuilt from the tree later on, which walks the current ring, so it must not lead here anymore.
+  if (pWidget->pFocusNext) {
+    if (pWidget->pFocusNext == pWidget) {
+      QP(pApplication)->pFocusFirst = NULL;
+    }
+    else {
+      pWidget->pFocusPrevious->pFocusNext = pWidget->pFocusNext;
+      pWidget->pFocusNext->pFocusPrevious = pWidget->pFocusPrevious;
+      if (QP(pApplication)->pFocusFirst == pWidget) {
+        QP(pApplication)->pFocusFirst = pWidget->pFocusNext;
+      }
+    }
+    pWidget->pFocusNext = NULL;
+    pWidget->pFocusPrevious = NULL;
+  }
+  if (QP(pApplication)->pSpatialIndex) {
+    qspatial_index_remove(QP(pApplication)->pSpatialIndex, pWidget);
+  }
 }
 
 //------------------------------------------------------------------------------
 static int qapplication_update_mouse (
   qapplication_t *                      pApplication
 ) {
+  int err;
   MEVENT mouseEvent;
   qmouse_t mouseState;
 
@@ -214,31 +347,198 @@ static int qapplication_update_mouse (
   // Sometimes this mouse event can trigger outside of the valid screen bounds.
   // TODO: Handle z (mousewheel).
   QP(pApplication)->mouseCoord = qcoord(
-    QMIN((size_t)mouseEvent.x, QP(pApplication)->painter.boundary.columns - 1),
-    QMIN((size_t)mouseEvent.y, QP(pApplication)->painter.boundary.rows    - 1)
+    QMAX(QMIN((qoffset_t)mouseEvent.x, (qoffset_t)QP(pApplication)->painter.boundary.columns - 1), 0),
+    QMAX(QMIN((qoffset_t)mouseEvent.y, (qoffset_t)QP(pApplication)->painter.boundary.rows    - 1), 0)
   );
 
-  // Emit the mouse event.
-  qwidget_emit(
-    pApplication,
-    on_mouse,
-    &QP(pApplication)->mouseCoord,
-    mouseState
-  );
+  // Hit-testing needs this frame's geometry, so catch up on any pending recalculation.
+  if (qwidget_is_dirty(pApplication)) {
+    err = qapplication_recalculate(pApplication, &QP(pApplication)->screenRegion);
+    if (err) {
+      return err;
+    }
+  }
+
+  return qapplication_route_mouse(pApplication, mouseState);
+}
+
+//------------------------------------------------------------------------------
+static int qapplication_link_focus (
+  qwidget_t *                           pWidget,
+  void *                                pUserData
+) {
+  qwidget_t * pFirst;
+  qapplication_t * pApplication;
+
+  // Append focusable widgets to the end of the ring (in painting order).
+  pApplication = (qapplication_t *)pUserData;
+  if (qwidget_is_focusable(pWidget)) {
+    pFirst = QP(pApplication)->pFocusFirst;
+    if (!pFirst) {
+      QP(pApplication)->pFocusFirst = pWidget;
+      pWidget->pFocusNext = pWidget;
+      pWidget->pFocusPrevious = pWidget;
+    }
+    else {
+      pWidget->pFocusNext = pFirst;
+      pWidget->pFocusPrevious = pFirst->pFocusPrevious;
+      pFirst->pFocusPrevious->pFocusNext = pWidget;
+      pFirst->pFocusPrevious = pWidget;
+    }
+  }
+
+  return qwidget_visit(pWidget, &qapplication_link_focus, pUserData);
+}
+
+// Note: Hidden and disabled widgets are kept in the ring and skipped when moving,
+//       this way only structural changes (parents, focusable state) need a rebuild.
+//------------------------------------------------------------------------------
+static void qapplication_update_focus_ring (
+  qapplication_t *                      pApplication
+) {
+  qwidget_t * pWidget;
+  qwidget_t * pNext;
+
+  if (QP(pApplication)->focusGeneration == qwidget_tree_generation()) {
+    return;
+  }
+
+  // Unlink the previous ring, so widgets which have left the tree are not reachable.
+  pWidget = QP(pApplication)->pFocusFirst;
+  while (pWidget) {
+    pNext = pWidget->pFocusNext;
+    pWidget->pFocusNext = NULL;
+    pWidget->pFocusPrevious = NULL;
+    pWidget = (pNext == QP(pApplication)->pFocusFirst) ? NULL : pNext;
+  }
+  QP(pApplication)->pFocusFirst = NULL;
+
+  // Note: Linking cannot fail, so the result of visiting is always 0.
+  (void)qapplication_link_focus(QW(pApplication), pApplication);
+  QP(pApplication)->focusGeneration = qwidget_tree_generation();
+
+  // The focused widget might have been removed (or made unfocusable).
+  pWidget = QP(pApplication)->pFocusWidget;
+  if (pWidget && !pWidget->pFocusNext) {
+    qwidget_unmark_state(pWidget, QSTATE_FOCUSED_BIT);
+    QP(pApplication)->pFocusWidget = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static qbool_t qapplication_can_focus (
+  qwidget_t *                           pWidget
+) {
+  if (!qwidget_is_focusable(pWidget)) {
+    return QFALSE;
+  }
+  for (; pWidget; pWidget = pWidget->pParent) {
+    if (!qwidget_is_visible(pWidget) || !qwidget_check_state(pWidget, QSTATE_ENABLED_BIT)) {
+      return QFALSE;
+    }
+  }
+  return QTRUE;
+}
+
+//------------------------------------------------------------------------------
+static int qapplication_move_focus (
+  qapplication_t *                      pApplication,
+  qbool_t                               forward
+) {
+  qwidget_t * pStart;
+  qwidget_t * pWidget;
+
+  // Start from the focused widget, or just before the head if nothing is focused.
+  qapplication_update_focus_ring(pApplication);
+  pStart = QP(pApplication)->pFocusWidget;
+  if (!pStart) {
+    pStart = QP(pApplication)->pFocusFirst;
+    if (!pStart) {
+      return 0;
+    }
+    if (forward) {
+      pStart = pStart->pFocusPrevious;
+    }
+  }
+
+  // Walk the ring, skipping over widgets that currently cannot take focus.
+  pWidget = pStart;
+  do {
+    pWidget = forward ? pWidget->pFocusNext : pWidget->pFocusPrevious;
+    if (qapplication_can_focus(pWidget)) {
+      return qapplication_set_focus(pApplication, pWidget);
+    }
+  } while (pWidget != pStart);
 
   return 0;
 }
 
+// Note: Keys bubble from the focused widget towards the application until accepted.
+//       Unaccepted tab keys move the focus, anything else goes to the on_key signal.
+//       Shortcuts take priority over all of these.
+//------------------------------------------------------------------------------
+static int qapplication_dispatch_key (
+  qapplication_t *                      pApplication,
+  qkey_t                                code,
+  qmodifier_t                           modifiers,
+  int                                   value
+) {
+  int err;
+  qwidget_t * pWidget;
+  qkey_event_t * pEvent;
+
+  pEvent = &QP(pApplication)->keyEvent;
+  pEvent->code = code;
+  pEvent->modifiers = modifiers;
+  pEvent->value = value;
+  pEvent->accepted = QFALSE;
+
+  // Shortcuts are matched first, with a single lookup per focus scope.
+  qapplication_update_focus_ring(pApplication);
+  err = qshortcut_map_dispatch(
+    QP(pApplication)->pShortcuts,
+    QP(pApplication)->pFocusWidget,
+    pEvent
+  );
+  if (err || pEvent->accepted) {
+    return err;
+  }
+
+  // The cost of dispatch depends only on the depth of the focused widget.
+  pWidget = QP(pApplication)->pFocusWidget;
+  if (!pWidget) {
+    pWidget = QW(pApplication);
+  }
+  for (; pWidget && !pEvent->accepted; pWidget = pWidget->pParent) {
+    err = qwidget_emit(pWidget, on_key_press, pEvent);
+    if (err) {
+      return err;
+    }
+  }
+  if (pEvent->accepted) {
+    return 0;
+  }
+
+  if (code == QKEY_TAB) {
+    return qapplication_move_focus(pApplication, QBOOL(!(modifiers & QMODIFIER_SHIFT_BIT)));
+  }
+
+  return qwidget_emit(pApplication, on_key, code, value);
+}
+
 //------------------------------------------------------------------------------
 #define QCASE(theirs, ours) case theirs: code = ours; break
+#define QCASE_SHIFT(theirs, ours) case theirs: code = ours; modifiers = QMODIFIER_SHIFT_BIT; break
 static int qapplication_update_input (
   qapplication_t *                      pApplication
 ) {
   int value;
   qkey_t code;
+  qmodifier_t modifiers;
 
-  // TODO: Add the shift/Ctrl/Alt key modifiers - this could be useful to some.
+  // TODO: Add the Alt key modifier - this could be useful to some.
   //       https://stackoverflow.com/questions/9750588/how-to-get-ctrl-shift-or-alt-with-getch-ncurses
+  modifiers = QMODIFIER_NONE;
   value = wgetch(QP(pApplication)->painter.pWindow);
   switch (value) {
 
@@ -261,44 +561,54 @@ static int qapplication_update_input (
       break;
     case 'A' ... 'Z':
       code = (qkey_t)tolower(value);
+      modifiers = QMODIFIER_SHIFT_BIT;
+      break;
+
+    // Control range (Ctrl+A through Ctrl+Z, except those which are mapped below)
+    case 0x01 ... 0x08:
+    case 0x0B ... 0x0C:
+    case 0x0E ... 0x1A:
+      code = (qkey_t)('a' + value - 1);
+      modifiers = QMODIFIER_CONTROL_BIT;
       break;
 
     // Standard ASCII range (mapped)
     QCASE('\x1B', QKEY_ESCAPE);
     QCASE('`', QKEY_BACKTICK);
-    QCASE('~', QKEY_BACKTICK);
-    QCASE('!', QKEY_1);
-    QCASE('@', QKEY_2);
-    QCASE('#', QKEY_3);
-    QCASE('$', QKEY_4);
-    QCASE('%', QKEY_5);
-    QCASE('^', QKEY_6);
-    QCASE('&', QKEY_7);
-    QCASE('*', QKEY_8);
-    QCASE('(', QKEY_9);
-    QCASE(')', QKEY_0);
+    QCASE_SHIFT('~', QKEY_BACKTICK);
+    QCASE_SHIFT('!', QKEY_1);
+    QCASE_SHIFT('@', QKEY_2);
+    QCASE_SHIFT('#', QKEY_3);
+    QCASE_SHIFT('$', QKEY_4);
+    QCASE_SHIFT('%', QKEY_5);
+    QCASE_SHIFT('^', QKEY_6);
+    QCASE_SHIFT('&', QKEY_7);
+    QCASE_SHIFT('*', QKEY_8);
+    QCASE_SHIFT('(', QKEY_9);
+    QCASE_SHIFT(')', QKEY_0);
     QCASE('-', QKEY_MINUS);
-    QCASE('_', QKEY_MINUS);
+    QCASE_SHIFT('_', QKEY_MINUS);
     QCASE('=', QKEY_EQUALS);
-    QCASE('+', QKEY_EQUALS);
+    QCASE_SHIFT('+', QKEY_EQUALS);
     QCASE('\t', QKEY_TAB);
     QCASE('[', QKEY_LEFT_BRACKET);
-    QCASE('{', QKEY_LEFT_BRACKET);
+    QCASE_SHIFT('{', QKEY_LEFT_BRACKET);
     QCASE(']', QKEY_RIGHT_BRACKET);
-    QCASE('}', QKEY_RIGHT_BRACKET);
+    QCASE_SHIFT('}', QKEY_RIGHT_BRACKET);
     QCASE('\\', QKEY_REVERSE_SOLIDUS);
-    QCASE('|', QKEY_REVERSE_SOLIDUS);
+    QCASE_SHIFT('|', QKEY_REVERSE_SOLIDUS);
     QCASE(';', QKEY_SEMICOLON);
-    QCASE(':', QKEY_SEMICOLON);
+    QCASE_SHIFT(':', QKEY_SEMICOLON);
     QCASE('\'', QKEY_SINGLE_QUOTE);
-    QCASE('"', QKEY_SINGLE_QUOTE);
+    QCASE_SHIFT('"', QKEY_SINGLE_QUOTE);
     QCASE('\n', QKEY_RETURN);
+    QCASE('\r', QKEY_RETURN);
     QCASE(',', QKEY_COMMA);
-    QCASE('<', QKEY_COMMA);
+    QCASE_SHIFT('<', QKEY_COMMA);
     QCASE('.', QKEY_PERIOD);
-    QCASE('>', QKEY_PERIOD);
+    QCASE_SHIFT('>', QKEY_PERIOD);
     QCASE('/', QKEY_SOLIDUS);
-    QCASE('?', QKEY_SOLIDUS);
+    QCASE_SHIFT('?', QKEY_SOLIDUS);
     QCASE(' ', QKEY_SPACE);
 
     // Special ncurses keycodes
@@ -323,20 +633,20 @@ static int qapplication_update_input (
     QCASE(KEY_F(12), QKEY_F12);
     QCASE(KEY_DC, QKEY_DELETE);
     QCASE(KEY_IC, QKEY_INSERT);
-    QCASE(KEY_SF, QKEY_DOWN);
-    QCASE(KEY_SR, QKEY_UP);
+    QCASE_SHIFT(KEY_SF, QKEY_DOWN);
+    QCASE_SHIFT(KEY_SR, QKEY_UP);
     QCASE(KEY_NPAGE, QKEY_PAGE_DOWN);
     QCASE(KEY_PPAGE, QKEY_PAGE_UP);
-    QCASE(KEY_BTAB, QKEY_TAB);
+    QCASE_SHIFT(KEY_BTAB, QKEY_TAB);
     QCASE(KEY_ENTER, QKEY_RETURN);
     QCASE(KEY_END, QKEY_END);
-    QCASE(KEY_SDC, QKEY_DELETE);
-    QCASE(KEY_SEND, QKEY_END);
-    QCASE(KEY_SHOME, QKEY_HOME);
-    QCASE(KEY_SLEFT, QKEY_LEFT);
-    QCASE(KEY_SNEXT, QKEY_PAGE_DOWN);
-    QCASE(KEY_SPREVIOUS, QKEY_PAGE_UP);
-    QCASE(KEY_SRIGHT, QKEY_RIGHT);
+    QCASE_SHIFT(KEY_SDC, QKEY_DELETE);
+    QCASE_SHIFT(KEY_SEND, QKEY_END);
+    QCASE_SHIFT(KEY_SHOME, QKEY_HOME);
+    QCASE_SHIFT(KEY_SLEFT, QKEY_LEFT);
+    QCASE_SHIFT(KEY_SNEXT, QKEY_PAGE_DOWN);
+    QCASE_SHIFT(KEY_SPREVIOUS, QKEY_PAGE_UP);
+    QCASE_SHIFT(KEY_SRIGHT, QKEY_RIGHT);
 
     // Unhandled (error)
     default:
@@ -344,10 +654,9 @@ static int qapplication_update_input (
       mvprintw(0, 0, "Unhandled value: 0x%x (%d) (0%o)\n", value, value, value);
       break;
   }
-  qwidget_emit(pApplication, on_key, code, value);
-
-  return 0;
+  return qapplication_dispatch_key(pApplication, code, modifiers, value);
 }
+#undef QCASE_SHIFT
 #undef QCASE
 
 //------------------------------------------------------------------------------
@@ -355,6 +664,14 @@ static int qapplication_update_input_blocking (
   qapplication_t *                      pApplication
 ) {
   int err;
+
+  // While background work is running, wake up regularly to pick up its result.
+  if (qwidget_background_count()) {
+    wtimeout(QP(pApplication)->painter.pWindow, QAPPLICATION_POLL_MS);
+    err = qapplication_update_input(pApplication);
+    return (err == ENODATA) ? 0 : err;
+  }
+
   err = nodelay(QP(pApplication)->painter.pWindow, FALSE);
   if (err == ERR) {
     return EFAULT;
@@ -389,6 +706,13 @@ static int qapplication_update (
     return err;
   }
 
+  // Pick up what other threads have finished, then deliver the queued/coalesced signals.
+  qflush_posted_updates();
+  err = qflush_signals();
+  if (err) {
+    return err;
+  }
+
   // Handle the visual update iff the application is marked dirty.
   if (qwidget_is_dirty(pApplication)) {
     err = qapplication_recalculate(pApplication, &QP(pApplication)->screenRegion);
@@ -436,6 +760,8 @@ int QCURSESCALL qcreate_application (
   widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_application);
   widgetConfig.pfnRecalculate = QRECALC_PTR(qapplication_recalculate);
   widgetConfig.pfnPaint       = QPAINTER_PTR(qapplication_paint);
+  widgetConfig.pfnVisit       = QVISIT_PTR(qapplication_visit);
+  widgetConfig.pfnMeasure     = NULL;
 
   // Allocate the terminal UI application.
   err = qcreate_widget(
@@ -446,6 +772,31 @@ int QCURSESCALL qcreate_application (
     return err;
   }
 
+  // Allocate the index used for routing mouse events to widgets.
+  err = qcreate_spatial_index(
+    QW(application)->pAllocator,
+    &QP(application)->pSpatialIndex
+  );
+  if (err) {
+    qfree(QW(application)->pAllocator, application);
+    return err;
+  }
+
+  // Allocate the registry of key bindings.
+  err = qcreate_shortcut_map(
+    QW(application)->pAllocator,
+    &QP(application)->pShortcuts
+  );
+  if (err) {
+    qdestroy_spatial_index(QP(application)->pSpatialIndex);
+    qfree(QW(application)->pAllocator, application);
+    return err;
+  }
+
+  // Force the tab order to be built on first use.
+  QP(application)->focusGeneration = qwidget_tree_generation() - 1;
+  qwidget_set_forget_hook(&qapplication_forget_widget, application);
+
   // Return the application to the caller.
   *pApplication = application;
   return 0;
@@ -456,7 +807,12 @@ void QCURSESCALL qdestroy_application (
   qapplication_t *                      pApplication
 ) {
   // TODO: Destroy application properly.
-  (void)pApplication;
+  qwidget_set_forget_hook(NULL, NULL);
+  qdestroy_spatial_index(QP(pApplication)->pSpatialIndex);
+  qdestroy_shortcut_map(QP(pApplication)->pShortcuts);
+  QP(pApplication)->pSpatialIndex = NULL;
+  QP(pApplication)->pShortcuts = NULL;
+  qteardown_signals();
 }
 
 //------------------------------------------------------------------------------
@@ -574,8 +930,7 @@ int QCURSESCALL qapplication_quit (
   int                                   code
 ) {
   QP(pApplication)->isQuitting = QTRUE;
-  qwidget_emit(pApplication, quit, code);
-  return 0;
+  return qwidget_emit(pApplication, quit, code);
 }
 
 //------------------------------------------------------------------------------
@@ -584,11 +939,110 @@ int QCURSESCALL __qapplication_set_main_widget (
   qwidget_t *                           pWidget
 ) {
   // TODO: What to do if another widget is disconnected?
-  pWidget->pParent = (qwidget_t *)pApplication;
+  qwidget_set_parent(pWidget, pApplication);
   QP(pApplication)->pMainWidget = pWidget;
+  qwidget_mark_dirty(pWidget);
   return 0;
 }
 
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qapplication_get_focus (
+  qapplication_t *                      pApplication
+) {
+  qapplication_update_focus_ring(pApplication);
+  return QP(pApplication)->pFocusWidget;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_set_focus (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pWidget
+) {
+  int err;
+  int result;
+  qwidget_t * pPrevious;
+
+  // Only widgets within the tab order can be focused (or NULL to clear focus).
+  qapplication_update_focus_ring(pApplication);
+  if (pWidget && !pWidget->pFocusNext) {
+    return EINVAL;
+  }
+  pPrevious = QP(pApplication)->pFocusWidget;
+  if (pPrevious == pWidget) {
+    return 0;
+  }
+
+  // Swap the focus first, so that the slots observe the final state.
+  result = 0;
+  QP(pApplication)->pFocusWidget = pWidget;
+  if (pPrevious) {
+    qwidget_unmark_state(pPrevious, QSTATE_FOCUSED_BIT);
+  }
+  if (pWidget) {
+    qwidget_mark_state(pWidget, QSTATE_FOCUSED_BIT);
+  }
+  if (pPrevious) {
+    result = qwidget_emit(pPrevious, on_focus, QFALSE);
+  }
+  if (pWidget) {
+    err = qwidget_emit(pWidget, on_focus, QTRUE);
+    if (err && !result) {
+      result = err;
+    }
+  }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qapplication_focus_next (
+  qapplication_t *                      pApplication
+) {
+  return qapplication_move_focus(pApplication, QTRUE);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qapplication_focus_previous (
+  qapplication_t *                      pApplication
+) {
+  return qapplication_move_focus(pApplication, QFALSE);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_add_shortcut (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count,
+  qwidget_t *                           pTarget,
+  qshortcut_pfn                         pfnAction
+) {
+  return qshortcut_map_insert(
+    QP(pApplication)->pShortcuts,
+    pScope,
+    pKeys,
+    count,
+    pTarget,
+    pfnAction
+  );
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_remove_shortcut (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count
+) {
+  qshortcut_map_cancel(QP(pApplication)->pShortcuts);
+  return qshortcut_map_remove(
+    QP(pApplication)->pShortcuts,
+    pScope,
+    pKeys,
+    count
+  );
+}
+
 //------------------------------------------------------------------------------
 int QCURSESCALL qapplication_set_status_bar (
   qapplication_t *                      pApplication,
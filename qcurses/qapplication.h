@@ -19,6 +19,7 @@
 #include "qcurses.h"
 #include "qwidget.h"
 #include "qmenu_bar.h"
+#include "qshortcut_map.h"
 #include "qstatus_bar.h"
 
 #ifdef    __cplusplus
@@ -48,7 +49,6 @@ QWIDGET_BEGIN(qapplication_t)
     QSIGNAL(quit, int code);
     QSIGNAL(resize, qbounds_t const * bounds);
     QSIGNAL(on_key, qkey_t code, int value);
-    QSIGNAL(on_mouse, qcoord_t const * coord, qmouse_t state);
   QWIDGET_SIGNALS_END
 QWIDGET_END
 
@@ -85,6 +85,88 @@ int QCURSESCALL __qapplication_set_main_widget (
     ((qwidget_t *)pWidget)                                                      \
   )
 
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qapplication_get_focus (
+  qapplication_t *                      pApplication
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_set_focus (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pWidget
+);
+
+// Focuses a focusable widget within the application (or clears focus with NULL).
+// The focused widget is the first to receive key presses, see on_key_press.
+//------------------------------------------------------------------------------
+#define qapplication_set_focus(pApplication, pWidget)                           \
+  __qapplication_set_focus(                                                     \
+    pApplication,                                                               \
+    ((qwidget_t *)pWidget)                                                      \
+  )
+
+// Moves the focus along the tab order, skipping hidden or disabled widgets.
+//------------------------------------------------------------------------------
+int QCURSESCALL qapplication_focus_next (
+  qapplication_t *                      pApplication
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qapplication_focus_previous (
+  qapplication_t *                      pApplication
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_add_shortcut (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count,
+  qwidget_t *                           pTarget,
+  qshortcut_pfn                         pfnAction
+);
+
+// Binds a sequence of keystrokes to a QSLOT_VOID slot of the target widget.
+// With a scope, the shortcut only applies while the scope (or a descendant) has focus.
+//------------------------------------------------------------------------------
+#define qapplication_add_shortcut(pApplication, pScope, pKeys, count, pTarget, slot) \
+  __qapplication_add_shortcut(                                                  \
+    pApplication,                                                               \
+    (qwidget_t *)(pScope),                                                      \
+    pKeys,                                                                      \
+    count,                                                                      \
+    (qwidget_t *)(pTarget),                                                     \
+    (qshortcut_pfn)(QSLOT_NAME(slot))&slot                                      \
+  )
+
+//------------------------------------------------------------------------------
+#define qapplication_add_shortcut_key(pApplication, pScope, code, modifiers, pTarget, slot) \
+  qapplication_add_shortcut(                                                    \
+    pApplication,                                                               \
+    pScope,                                                                     \
+    (&(qkeystroke_t const){ code, modifiers }),                                 \
+    1,                                                                          \
+    pTarget,                                                                    \
+    slot                                                                        \
+  )
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qapplication_remove_shortcut (
+  qapplication_t *                      pApplication,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count
+);
+
+//------------------------------------------------------------------------------
+#define qapplication_remove_shortcut(pApplication, pScope, pKeys, count)        \
+  __qapplication_remove_shortcut(                                               \
+    pApplication,                                                               \
+    (qwidget_t *)(pScope),                                                      \
+    pKeys,                                                                      \
+    count                                                                       \
+  )
+
 //------------------------------------------------------------------------------
 qmenu_bar_t * QCURSESCALL qapplication_get_menu_bar (
   qapplication_t *                      pApplication
@@ -71,7 +71,7 @@ void QCURSESCALL __qarray_deinit (
 #define qarray_deinit(pAllocator, pArray)                                       \
   __qarray_deinit(                                                              \
     pAllocator,                                                                 \
-    (qarray_t *)(pArray),                                                       \
+    (qarray_t *)(pArray)                                                        \
   )
 
 //------------------------------------------------------------------------------
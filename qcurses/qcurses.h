@@ -32,12 +32,14 @@ extern "C" {
 #define QFALSE 0
 #define QTRUE  1
 #define QBOOL(stmt) ((stmt) ? QTRUE : QFALSE)
-#define QINFINITE            SIZE_MAX
+#define QINFINITE            UINT32_MAX
 #define QSIGNAL_MAX          UINT32_MAX
 #define QPIMPL_NAME(name)    _##name##_impl_t
 #define QSLOT_NAME(name)     _##name##_slot_t
 #define QRECALC_NAME(name)   _##name##_recalc_t
 #define QPAINTER_NAME(name)  _##name##_painter_t
+#define QVISIT_NAME(name)    _##name##_visit_t
+#define QMEASURE_NAME(name)  _##name##_measure_t
 #define QPIMPL_STRUCT(name)  struct QPIMPL_NAME(name)
 #define QMIN(a,b)            (((a) < (b)) ? (a) : (b))
 #define QMAX(a,b)            (((a) > (b)) ? (a) : (b))
@@ -173,6 +175,12 @@ enum qstate_bits_t {
   QSTATE_DIRTY_BIT = 0x01,
   QSTATE_ENABLED_BIT = 0x02,
   QSTATE_VISIBLE_BIT = 0x04,
+  QSTATE_UPDATING_BIT = 0x08,   // Widget is the root of an open update transaction.
+  QSTATE_DEFERRED_BIT = 0x10,   // Dirty propagation was held back by the transaction.
+  QSTATE_FOCUSABLE_BIT = 0x20,  // Widget takes part in the application's tab order.
+  QSTATE_FOCUSED_BIT = 0x40,    // Widget is the first to receive key presses.
+  QSTATE_MEASURE_BIT = 0x80,    // Cached size hint is stale, see qwidget_update_geometry().
+  QSTATE_REPAINT_BIT = 0x100,   // Parent cleared what was shown, see qwidget_mark_repaint().
 };
 
 //------------------------------------------------------------------------------
@@ -197,6 +205,19 @@ enum qpolicy_bits_t {
 #define QPOLICY_FLEXIBLE   (QPOLICY_GROW_BIT | QPOLICY_EXPAND_BIT)
 #define QPOLICY_IGNORED    (QPOLICY_GROW_BIT | QPOLICY_SHRINK_BIT | QPOLICY_IGNORE_BIT)
 
+// Note: The color is a color pair (set up with init_pair()), held above the attribute bits.
+//------------------------------------------------------------------------------
+enum qstyle_bits_t {
+  QSTYLE_BOLD_BIT = 0x01,
+  QSTYLE_DIM_BIT = 0x02,
+  QSTYLE_UNDERLINE_BIT = 0x04,
+  QSTYLE_REVERSE_BIT = 0x08,
+  QSTYLE_BLINK_BIT = 0x10,
+};
+#define QSTYLE_NONE        (0)
+#define QSTYLE_COLOR_SHIFT (8)
+#define QSTYLE_COLOR(pair) ((qstyle_t)(pair) << QSTYLE_COLOR_SHIFT)
+
 //------------------------------------------------------------------------------
 enum qalign_bits_t {
   // Mutually-exclusive horizontal bits:
@@ -220,8 +241,11 @@ typedef int       qbool_t;
 typedef uint32_t  qflags_t;
 
 // Enums
+QDECLARE_ENUM(qdelivery_t);
 QDECLARE_ENUM(qkey_t);
 QDECLARE_ENUM(qlayout_format_t);
+QDECLARE_ENUM(qtrack_sizing_t);
+QDECLARE_ENUM(qwrap_t);
 
 // Flags
 QDECLARE_FLAGS(qalign_bits_t, qalign_t);
@@ -229,6 +253,7 @@ QDECLARE_FLAGS(qmodifier_bits_t, qmodifier_t);
 QDECLARE_FLAGS(qmouse_bits_t, qmouse_t);
 QDECLARE_FLAGS(qpolicy_bits_t, qpolicy_t);
 QDECLARE_FLAGS(qstate_bits_t, qstate_t);
+QDECLARE_FLAGS(qstyle_bits_t, qstyle_t);
 
 // Structs
 QDECLARE_STRUCT(qalloc_t);
@@ -236,6 +261,7 @@ QDECLARE_STRUCT(qapplication_t);
 QDECLARE_STRUCT(qapplication_info_t);
 QDECLARE_STRUCT(qbounds_t);
 QDECLARE_STRUCT(qcoord_t);
+QDECLARE_STRUCT(qkey_event_t);
 QDECLARE_STRUCT(qlayout_t);
 QDECLARE_STRUCT(qpainter_t);
 QDECLARE_STRUCT(qregion_t);
@@ -0,0 +1,591 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qgrid_layout.h"
+#include "qpainter.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Grid Layout Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// Rows and columns are sized the same way, so everything is indexed by axis.
+#define QGRID_ROWS                      0
+#define QGRID_COLUMNS                   1
+#define QGRID_AXES                      2
+
+//------------------------------------------------------------------------------
+typedef struct qgrid_track_t {
+  qtrack_sizing_t                       sizing;
+  qextent_t                             value;          // Fixed extent, or fraction weight.
+  qextent_t                             measured;       // Preferred extent from the content.
+  qextent_t                             extent;         // Resolved extent within the region.
+  qextent_t                             offset;         // Resolved offset within the region.
+} qgrid_track_t;
+
+//------------------------------------------------------------------------------
+typedef struct qgrid_cell_t {
+  qwidget_t *                           pWidget;
+  uint32_t                              start[QGRID_AXES];
+  uint32_t                              span[QGRID_AXES];
+  qregion_t                             region;         // The region last given to the widget.
+} qgrid_cell_t;
+
+//------------------------------------------------------------------------------
+typedef QDEFINE_ARRAY(qgrid_track_t) qgrid_tracks_t;
+
+// Note: Track offsets are only resolved again when a hint or the region bounds change.
+//       Cells are only placed again when a hint or the region (bounds or coord) change.
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qgrid_layout_t) {
+  qgrid_tracks_t                        tracks[QGRID_AXES];
+  QDEFINE_ARRAY(qgrid_cell_t)           cells;
+  qbounds_t                             resolvedBounds;
+  qbool_t                               resolvedStale;
+  qregion_t                             placedRegion;
+  qbool_t                               placedStale;
+};
+
+//------------------------------------------------------------------------------
+static inline qextent_t qgrid_axis_extent (
+  uint32_t                              axis,
+  qbounds_t const *                     pBounds
+) {
+  return axis == QGRID_ROWS ? pBounds->rows : pBounds->columns;
+}
+
+//------------------------------------------------------------------------------
+static int qgrid_layout_ensure_tracks (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              axis,
+  uint32_t                              count
+) {
+  int err;
+  qgrid_track_t track;
+
+  memset(&track, 0, sizeof(track));
+  track.sizing = QTRACK_CONTENT;
+  while (QP(pGrid)->tracks[axis].count < count) {
+    err = qarray_push(QW(pGrid)->pAllocator, &QP(pGrid)->tracks[axis], track);
+    if (err) {
+      return err;
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int qgrid_layout_set_track (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              axis,
+  uint32_t                              idx,
+  qtrack_sizing_t                       sizing,
+  qextent_t                             value
+) {
+  int err;
+  qgrid_track_t * pTrack;
+
+  if (idx == UINT32_MAX) {
+    return ERANGE;
+  }
+  err = qgrid_layout_ensure_tracks(pGrid, axis, idx + 1);
+  if (err) {
+    return err;
+  }
+
+  pTrack = &QP(pGrid)->tracks[axis].pData[idx];
+  if (pTrack->sizing != sizing || pTrack->value != value) {
+    pTrack->sizing = sizing;
+    pTrack->value = value;
+    qwidget_update_geometry(pGrid);
+  }
+  return 0;
+}
+
+// Spreads the extent evenly over the tracks of a span which are sized by content.
+// Fraction tracks are only used when the span has no content tracks to grow.
+//------------------------------------------------------------------------------
+static qbool_t qgrid_layout_spread (
+  qgrid_track_t *                       pTracks,
+  uint32_t                              count,
+  qtrack_sizing_t                       sizing,
+  uint64_t                              extent
+) {
+  uint32_t idx;
+  uint64_t given;
+  uint64_t share;
+  uint64_t accumulated;
+  uint64_t targets;
+
+  targets = 0;
+  for (idx = 0; idx < count; ++idx) {
+    targets += (pTracks[idx].sizing == sizing);
+  }
+  if (!targets) {
+    return QFALSE;
+  }
+
+  given = 0;
+  accumulated = 0;
+  for (idx = 0; idx < count; ++idx) {
+    if (pTracks[idx].sizing != sizing) {
+      continue;
+    }
+    ++accumulated;
+    share = extent * accumulated / targets - given;
+    given += share;
+    pTracks[idx].measured = (qextent_t)QMIN(pTracks[idx].measured + share, (uint64_t)QINFINITE);
+  }
+  return QTRUE;
+}
+
+// Calculates the preferred extent of each track along the axis from the cell hints.
+// Cells spanning several tracks only grow them if the single-track cells were not enough.
+//------------------------------------------------------------------------------
+static int qgrid_layout_measure_tracks (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              axis,
+  uint64_t *                            pTotal
+) {
+  int err;
+  uint32_t idx;
+  uint32_t span;
+  uint64_t spanned;
+  qextent_t extent;
+  qbounds_t hint;
+  qgrid_cell_t const * pCell;
+  qgrid_track_t * pTracks;
+
+  pTracks = QP(pGrid)->tracks[axis].pData;
+  for (idx = 0; idx < QP(pGrid)->tracks[axis].count; ++idx) {
+    pTracks[idx].measured = pTracks[idx].sizing == QTRACK_FIXED ? pTracks[idx].value : 0;
+  }
+
+  // Single-track cells first, which decide the extent of most tracks.
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    pCell = &QP(pGrid)->cells.pData[idx];
+    if (pCell->span[axis] != 1 || pTracks[pCell->start[axis]].sizing == QTRACK_FIXED) {
+      continue;
+    }
+    err = qwidget_size_hint(pCell->pWidget, &hint);
+    if (err) {
+      return err;
+    }
+    extent = qgrid_axis_extent(axis, &hint);
+    pTracks[pCell->start[axis]].measured = QMAX(pTracks[pCell->start[axis]].measured, extent);
+  }
+
+  // Then any spanning cells, which only take what the spanned tracks are missing.
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    pCell = &QP(pGrid)->cells.pData[idx];
+    if (pCell->span[axis] == 1) {
+      continue;
+    }
+    err = qwidget_size_hint(pCell->pWidget, &hint);
+    if (err) {
+      return err;
+    }
+    spanned = 0;
+    for (span = 0; span < pCell->span[axis]; ++span) {
+      spanned += pTracks[pCell->start[axis] + span].measured;
+    }
+    extent = qgrid_axis_extent(axis, &hint);
+    if (spanned < extent &&
+        !qgrid_layout_spread(&pTracks[pCell->start[axis]], pCell->span[axis], QTRACK_CONTENT, extent - spanned)) {
+      qgrid_layout_spread(&pTracks[pCell->start[axis]], pCell->span[axis], QTRACK_FRACTION, extent - spanned);
+    }
+  }
+
+  *pTotal = 0;
+  for (idx = 0; idx < QP(pGrid)->tracks[axis].count; ++idx) {
+    *pTotal += pTracks[idx].measured;
+  }
+  return 0;
+}
+
+// Fixed and content tracks take their measured extent, and fractions share the rest.
+// Note: Offsets are limited to the available extent, so trailing tracks are clipped.
+//------------------------------------------------------------------------------
+static void qgrid_layout_resolve_tracks (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              axis,
+  qextent_t                             available
+) {
+  uint32_t idx;
+  uint64_t used;
+  uint64_t weights;
+  uint64_t remaining;
+  uint64_t given;
+  uint64_t share;
+  uint64_t accumulated;
+  qgrid_track_t * pTracks;
+
+  used = 0;
+  weights = 0;
+  pTracks = QP(pGrid)->tracks[axis].pData;
+  for (idx = 0; idx < QP(pGrid)->tracks[axis].count; ++idx) {
+    if (pTracks[idx].sizing == QTRACK_FRACTION) {
+      weights += pTracks[idx].value;
+      pTracks[idx].extent = 0;
+    }
+    else {
+      used += pTracks[idx].measured;
+      pTracks[idx].extent = pTracks[idx].measured;
+    }
+  }
+
+  remaining = used < available ? available - used : 0;
+  if (weights) {
+    given = 0;
+    accumulated = 0;
+    for (idx = 0; idx < QP(pGrid)->tracks[axis].count; ++idx) {
+      if (pTracks[idx].sizing != QTRACK_FRACTION) {
+        continue;
+      }
+      accumulated += pTracks[idx].value;
+      share = remaining * accumulated / weights - given;
+      given += share;
+      pTracks[idx].extent = (qextent_t)share;
+    }
+  }
+
+  used = 0;
+  for (idx = 0; idx < QP(pGrid)->tracks[axis].count; ++idx) {
+    pTracks[idx].offset = (qextent_t)QMIN(used, (uint64_t)available);
+    pTracks[idx].extent = (qextent_t)QMIN((uint64_t)pTracks[idx].extent, available - pTracks[idx].offset);
+    used += pTracks[idx].extent;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void qgrid_layout_cell_range (
+  qgrid_layout_t const *                pGrid,
+  qgrid_cell_t const *                  pCell,
+  uint32_t                              axis,
+  qextent_t *                           pOffset,
+  qextent_t *                           pExtent
+) {
+  qgrid_track_t const * pFirst;
+  qgrid_track_t const * pLast;
+  pFirst = &QP(pGrid)->tracks[axis].pData[pCell->start[axis]];
+  pLast = &QP(pGrid)->tracks[axis].pData[pCell->start[axis] + pCell->span[axis] - 1];
+  *pOffset = pFirst->offset;
+  *pExtent = pLast->offset + pLast->extent - pFirst->offset;
+}
+
+//------------------------------------------------------------------------------
+QMEASURE(
+  qgrid_layout_measure,
+  qgrid_layout_t *                      pGrid,
+  qbounds_t *                           pHint
+) {
+  int err;
+  uint64_t rows;
+  uint64_t columns;
+
+  err = qgrid_layout_measure_tracks(pGrid, QGRID_ROWS, &rows);
+  if (err) {
+    return err;
+  }
+  err = qgrid_layout_measure_tracks(pGrid, QGRID_COLUMNS, &columns);
+  if (err) {
+    return err;
+  }
+
+  // The measured extents changed, so the resolved offsets have to follow.
+  QP(pGrid)->resolvedStale = QTRUE;
+  QP(pGrid)->placedStale = QTRUE;
+  *pHint = qbounds(
+    (qextent_t)QMIN(rows, (uint64_t)QINFINITE),
+    (qextent_t)QMIN(columns, (uint64_t)QINFINITE)
+  );
+  return 0;
+}
+
+// Places each cell over its tracks (no larger than the widget allows).
+//------------------------------------------------------------------------------
+static int qgrid_layout_place (
+  qgrid_layout_t *                      pGrid,
+  qregion_t const *                     pRegion
+) {
+  int err;
+  uint32_t idx;
+  qextent_t rowOffset;
+  qextent_t rowExtent;
+  qextent_t columnOffset;
+  qextent_t columnExtent;
+  qgrid_cell_t * pCell;
+
+  if (QP(pGrid)->resolvedStale || !qbounds_equal(&QP(pGrid)->resolvedBounds, &pRegion->bounds)) {
+    qgrid_layout_resolve_tracks(pGrid, QGRID_ROWS, pRegion->bounds.rows);
+    qgrid_layout_resolve_tracks(pGrid, QGRID_COLUMNS, pRegion->bounds.columns);
+    QP(pGrid)->resolvedBounds = pRegion->bounds;
+    QP(pGrid)->resolvedStale = QFALSE;
+  }
+
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    pCell = &QP(pGrid)->cells.pData[idx];
+    qgrid_layout_cell_range(pGrid, pCell, QGRID_ROWS, &rowOffset, &rowExtent);
+    qgrid_layout_cell_range(pGrid, pCell, QGRID_COLUMNS, &columnOffset, &columnExtent);
+    pCell->region = qregion(
+      pRegion->coord.column + (qoffset_t)columnOffset,
+      pRegion->coord.row + (qoffset_t)rowOffset,
+      QMIN(rowExtent, pCell->pWidget->maximumBounds.rows),
+      QMIN(columnExtent, pCell->pWidget->maximumBounds.columns)
+    );
+    err = qwidget_recalculate(pCell->pWidget, &pCell->region);
+    if (err) {
+      return err;
+    }
+  }
+
+  QP(pGrid)->placedRegion = *pRegion;
+  QP(pGrid)->placedStale = QFALSE;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QRECALC(
+  qgrid_layout_recalculate,
+  qgrid_layout_t *                      pGrid,
+  qregion_t const *                     pRegion
+) {
+  int err;
+  uint32_t idx;
+  qbounds_t hint;
+  qgrid_cell_t * pCell;
+
+  // Calculate the full widget region information.
+  QW(pGrid)->contentBounds = pRegion->bounds;
+  QW(pGrid)->outerRegion = *pRegion;
+  QW(pGrid)->innerRegion = *pRegion;
+
+  // Our parent has usually measured us already, in which case this is cached.
+  err = qwidget_size_hint(pGrid, &hint);
+  if (err) {
+    return err;
+  }
+
+  // If the cells would land where they already are, only dirty cells need updating.
+  if (!QP(pGrid)->placedStale && qregion_equal(&QP(pGrid)->placedRegion, pRegion)) {
+    for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+      pCell = &QP(pGrid)->cells.pData[idx];
+      if (qwidget_is_dirty(pCell->pWidget)) {
+        err = qwidget_recalculate(pCell->pWidget, &pCell->region);
+        if (err) {
+          return err;
+        }
+      }
+    }
+  }
+  else {
+    err = qgrid_layout_place(pGrid, pRegion);
+    if (err) {
+      return err;
+    }
+  }
+
+  // A cell may only learn its hint once placed (e.g. wrapped text at its new width).
+  // Then the placement is already out of date, so the grid is measured and placed once more.
+  if (qwidget_check_state(pGrid, QSTATE_MEASURE_BIT)) {
+    err = qwidget_size_hint(pGrid, &hint);
+    if (err) {
+      return err;
+    }
+    return qgrid_layout_place(pGrid, pRegion);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QPAINTER(
+  qgrid_layout_paint,
+  qgrid_layout_t *                      pGrid,
+  qpainter_t *                          pPainter
+) {
+  int err;
+  uint32_t idx;
+  qregion_t clip;
+  qregion_t overlap;
+
+  // Cells outside of the clip are left dirty, whatever brings them into view repaints them.
+  clip = qpainter_get_clip(pPainter);
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    overlap = qregion_intersect(&QP(pGrid)->cells.pData[idx].pWidget->outerRegion, &clip);
+    if (qregion_empty(&overlap)) {
+      continue;
+    }
+    err = qwidget_paint(QP(pGrid)->cells.pData[idx].pWidget, pPainter);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Clear the dirty state, otherwise child updates would stop propagating here.
+  qwidget_unmark_dirty(pGrid);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QVISIT(
+  qgrid_layout_visit,
+  qgrid_layout_t *                      pGrid,
+  qwidget_visitor_pfn                   pfnVisitor,
+  void *                                pUserData
+) {
+  int err;
+  uint32_t idx;
+
+  // Visit the cells in the same order that they are painted.
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    err = pfnVisitor(QP(pGrid)->cells.pData[idx].pWidget, pUserData);
+    if (err) {
+      return err;
+    }
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Grid Layout Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_grid_layout (
+  qalloc_t const *                      pAllocator,
+  qgrid_layout_t **                     pGrid
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qgrid_layout_t * grid;
+
+  // Configure the grid as a widget so that it can be nested.
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qgrid_layout_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qgrid_layout_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_grid_layout);
+  widgetConfig.pfnRecalculate = QRECALC_PTR(qgrid_layout_recalculate);
+  widgetConfig.pfnPaint       = QPAINTER_PTR(qgrid_layout_paint);
+  widgetConfig.pfnVisit       = QVISIT_PTR(qgrid_layout_visit);
+  widgetConfig.pfnMeasure     = QMEASURE_PTR(qgrid_layout_measure);
+
+  // Allocate the grid layout.
+  err = qcreate_widget(
+    &widgetConfig,
+    &grid
+  );
+  if (err) {
+    return err;
+  }
+
+  // Nothing has been resolved (or placed) yet.
+  QP(grid)->resolvedStale = QTRUE;
+  QP(grid)->placedStale = QTRUE;
+
+  // Return the grid to the caller.
+  *pGrid = grid;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_grid_layout (
+  qgrid_layout_t *                      pGrid
+) {
+  uint32_t idx;
+  qalloc_t const * pAllocator;
+
+  for (idx = 0; idx < QP(pGrid)->cells.count; ++idx) {
+    qdestroy_widget(QP(pGrid)->cells.pData[idx].pWidget);
+  }
+
+  pAllocator = QW(pGrid)->pAllocator;
+  qarray_deinit(pAllocator, &QP(pGrid)->cells);
+  qarray_deinit(pAllocator, &QP(pGrid)->tracks[QGRID_ROWS]);
+  qarray_deinit(pAllocator, &QP(pGrid)->tracks[QGRID_COLUMNS]);
+  qfree(pAllocator, pGrid);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qgrid_layout_set_row (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              row,
+  qtrack_sizing_t                       sizing,
+  qextent_t                             value
+) {
+  return qgrid_layout_set_track(pGrid, QGRID_ROWS, row, sizing, value);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qgrid_layout_set_column (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              column,
+  qtrack_sizing_t                       sizing,
+  qextent_t                             value
+) {
+  return qgrid_layout_set_track(pGrid, QGRID_COLUMNS, column, sizing, value);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qgrid_layout_add_widget (
+  qgrid_layout_t *                      pGrid,
+  qwidget_t *                           pWidget,
+  uint32_t                              row,
+  uint32_t                              column,
+  uint32_t                              rowSpan,
+  uint32_t                              columnSpan
+) {
+  int err;
+  qgrid_cell_t cell;
+
+  if (!rowSpan || !columnSpan) {
+    return EINVAL;
+  }
+  if (row > UINT32_MAX - rowSpan || column > UINT32_MAX - columnSpan) {
+    return ERANGE;
+  }
+
+  // Make sure that every track the cell covers exists.
+  err = qgrid_layout_ensure_tracks(pGrid, QGRID_ROWS, row + rowSpan);
+  if (err) {
+    return err;
+  }
+  err = qgrid_layout_ensure_tracks(pGrid, QGRID_COLUMNS, column + columnSpan);
+  if (err) {
+    return err;
+  }
+
+  cell.pWidget = pWidget;
+  cell.start[QGRID_ROWS] = row;
+  cell.start[QGRID_COLUMNS] = column;
+  cell.span[QGRID_ROWS] = rowSpan;
+  cell.span[QGRID_COLUMNS] = columnSpan;
+  err = qarray_push(QW(pGrid)->pAllocator, &QP(pGrid)->cells, cell);
+  if (err) {
+    return err;
+  }
+
+  qwidget_set_parent(pWidget, pGrid);
+  return 0;
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QGRID_LAYOUT_H
+#define   QGRID_LAYOUT_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Grid Layout Definition
+////////////////////////////////////////////////////////////////////////////////
+
+// How the extent of a row or column is decided.
+//------------------------------------------------------------------------------
+enum qtrack_sizing_t {
+  QTRACK_CONTENT,       // The largest size hint of the widgets within the track.
+  QTRACK_FIXED,         // Exactly the given extent.
+  QTRACK_FRACTION       // A share (by the given weight) of the space left by the others.
+};
+
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qgrid_layout_t)
+  // Intentionally Empty
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// Grid Layout Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_grid_layout (
+  qalloc_t const *                      pAllocator,
+  qgrid_layout_t **                     pGrid
+);
+
+// Note: The grid owns the widgets added to it, and destroys them along with itself.
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_grid_layout (
+  qgrid_layout_t *                      pGrid
+);
+
+// Tracks are added as needed by widgets, and default to QTRACK_CONTENT.
+//------------------------------------------------------------------------------
+int QCURSESCALL qgrid_layout_set_row (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              row,
+  qtrack_sizing_t                       sizing,
+  qextent_t                             value
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qgrid_layout_set_column (
+  qgrid_layout_t *                      pGrid,
+  uint32_t                              column,
+  qtrack_sizing_t                       sizing,
+  qextent_t                             value
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qgrid_layout_add_widget (
+  qgrid_layout_t *                      pGrid,
+  qwidget_t *                           pWidget,
+  uint32_t                              row,
+  uint32_t                              column,
+  uint32_t                              rowSpan,
+  uint32_t                              columnSpan
+);
+
+// Places the widget in the cell, covering rowSpan rows and columnSpan columns.
+//------------------------------------------------------------------------------
+#define qgrid_layout_add_widget(pGrid, pWidget, row, column, rowSpan, columnSpan) \
+  __qgrid_layout_add_widget(                                                    \
+    pGrid,                                                                      \
+    (qwidget_t *)(pWidget),                                                     \
+    row,                                                                        \
+    column,                                                                     \
+    rowSpan,                                                                    \
+    columnSpan                                                                  \
+  )
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QGRID_LAYOUT_H
@@ -16,8 +16,10 @@
 
 #include "qlabel.h"
 #include "qpainter.h"
-#include "detail/lt3alloc.h"
-#include <lt3/string/pstring.h>
+#include "qscan.h"
+#include "qstring.h"
+#include <stdio.h>
+#include <string.h>
 
 // TODO: Text shifts when contentRegion > innerRegion, when ideally it should not.
 #ifdef    __cplusplus
@@ -28,18 +30,1012 @@ extern "C" {
 // Label Implementations
 ////////////////////////////////////////////////////////////////////////////////
 
+// A visual row of wrapped text, which is always part of one line.
+//------------------------------------------------------------------------------
+typedef struct qlabel_span_t {
+  size_t                                offset;
+  size_t                                length;
+} qlabel_span_t;
+
+//------------------------------------------------------------------------------
+typedef QDEFINE_ARRAY(qlabel_span_t) qlabel_rows_t;
+
+// How a line was broken into rows, the same breaks are made for any width in [minWidth, maxWidth).
+//------------------------------------------------------------------------------
+typedef struct qlabel_wrap_line_t {
+  uint32_t                              rowCount;
+  qextent_t                             minWidth;
+  qextent_t                             maxWidth;
+} qlabel_wrap_line_t;
+
+// The rows of the text wrapped at the last width, built lazily as far as lines.count lines.
+// Note: Changing the width only breaks the lines again whose breaks differ at the new width.
+//------------------------------------------------------------------------------
+typedef struct qlabel_wrap_t {
+  qextent_t                             width;          // 0 until the text is first wrapped.
+  QDEFINE_ARRAY(qlabel_wrap_line_t)     lines;
+  qlabel_rows_t                         rows;
+  qlabel_rows_t                         spareRows;      // Rows being rebuilt, swapped with rows.
+} qlabel_wrap_t;
+
+// What is known about a line, so that replacing the text only paints the lines which changed.
+//------------------------------------------------------------------------------
+typedef struct qlabel_line_t {
+  uint64_t                              hash;
+  qbool_t                               changed;        // The text differs from what was painted.
+  size_t                                changedFirst;   // The bytes [first, last) of the line which changed.
+  size_t                                changedLast;
+  qextent_t                             paintedColumn;  // Relative to the inner region.
+  qextent_t                             paintedLength;
+} qlabel_line_t;
+
 //------------------------------------------------------------------------------
 struct QPIMPL_NAME(qlabel_t) {
-  qlt3alloc_t                           allocator;
   qalign_t                              alignment;
-  lt3_pstring_t                         contents;
+  qwrap_t                               wrap;
+  qstyle_t                              styles[QLABEL_STYLE_COUNT];
+  qlabel_wrap_t                         wrapped;
+  uint32_t                              measuredRows;   // The rows last reported by measure.
+  qstring_t                             contents;
+  qbool_t                               isBorrowed;
+  char const *                          pBorrowed;
+  uint32_t                              borrowedLength;
+  qlabel_release_pfn                    pfnRelease;
+  uint32_t                              firstByte;
   size_t                                maxLineLength;
   QDEFINE_ARRAY(size_t)                 lines;
+  uint32_t                              firstLine;
+  QDEFINE_ARRAY(uint32_t)               longest;        // Lines (into lines) getting shorter, the first is the longest.
+  uint32_t                              longestFirst;
+  QDEFINE_ARRAY(qlabel_run_t)           runs;           // Offsets into the data, like lines.
+  QDEFINE_ARRAY(qlabel_run_t)           pendingRuns;    // Runs being parsed, swapped with runs.
+  QDEFINE_ARRAY(qlabel_line_t)          lineStates;     // Only valid for text set as a whole.
+  qbool_t                               repaintAll;
+  qpainter_state_t                      paintedState;
 };
 
-////////////////////////////////////////////////////////////////////////////////
-// Label Functions
-////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(set_align, qalign_t);
+QDEFINE_EMITTER(set_wrap, qwrap_t);
+QDEFINE_EMITTER(set_style, uint32_t, qstyle_t);
+QDEFINE_EMITTER(set_text, char const *, size_t);
+QDEFINE_EMITTER(append_text, char const *, size_t);
+QDEFINE_EMITTER(truncate_text, size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Label Helpers
+////////////////////////////////////////////////////////////////////////////////
+
+// Truncated text is only skipped over (firstByte/firstLine), and moved once it is most of the buffer.
+// This keeps dropping lines from the front of a log at an amortized cost of the dropped lines.
+// Note: lines holds the offset of every line start, followed by the offset just past the last line.
+//       So line idx is data[lines[idx], lines[idx + 1]), including its newline (if it has one).
+//------------------------------------------------------------------------------
+static inline char const * qlabel_data (
+  qlabel_t *                            pLabel
+) {
+  return QP(pLabel)->isBorrowed ? QP(pLabel)->pBorrowed : qstring_data(&QP(pLabel)->contents);
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t qlabel_data_length (
+  qlabel_t *                            pLabel
+) {
+  return QP(pLabel)->isBorrowed ? QP(pLabel)->borrowedLength : QP(pLabel)->contents.length;
+}
+
+//------------------------------------------------------------------------------
+static inline char const * qlabel_text (
+  qlabel_t *                            pLabel
+) {
+  return qlabel_data(pLabel) + QP(pLabel)->firstByte;
+}
+
+//------------------------------------------------------------------------------
+static inline size_t qlabel_text_length (
+  qlabel_t *                            pLabel
+) {
+  return qlabel_data_length(pLabel) - QP(pLabel)->firstByte;
+}
+
+//------------------------------------------------------------------------------
+static inline size_t * qlabel_lines (
+  qlabel_t *                            pLabel
+) {
+  return QP(pLabel)->lines.pData + QP(pLabel)->firstLine;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t qlabel_line_count (
+  qlabel_t *                            pLabel
+) {
+  uint32_t const offsetCount = QP(pLabel)->lines.count - QP(pLabel)->firstLine;
+  return offsetCount ? offsetCount - 1 : 0;
+}
+
+// Note: Every line has at least one byte, either its newline or (for the last line) some text.
+//------------------------------------------------------------------------------
+static inline size_t qlabel_line_length (
+  qlabel_t *                            pLabel,
+  uint32_t                              idx
+) {
+  size_t const * pLines = qlabel_lines(pLabel);
+  size_t end = pLines[idx + 1];
+  if (qlabel_data(pLabel)[end - 1] == '\n') {
+    --end;
+  }
+  return end - pLines[idx];
+}
+
+// Note: Unlike qlabel_line_length(), the line is an index into lines (not counting from firstLine).
+//------------------------------------------------------------------------------
+static inline size_t qlabel_line_length_at (
+  qlabel_t *                            pLabel,
+  uint32_t                              line
+) {
+  return qlabel_line_length(pLabel, line - QP(pLabel)->firstLine);
+}
+
+// Lines are only added at the end and dropped from the front, so the longest is kept as a sliding maximum.
+// A line followed by a line at least as long can never be the longest again, so it is not kept.
+//------------------------------------------------------------------------------
+static void qlabel_settle_max (
+  qlabel_t *                            pLabel
+) {
+  if (QP(pLabel)->longestFirst == QP(pLabel)->longest.count) {
+    QP(pLabel)->maxLineLength = 0;
+    return;
+  }
+  QP(pLabel)->maxLineLength = qlabel_line_length_at(pLabel, QP(pLabel)->longest.pData[QP(pLabel)->longestFirst]);
+}
+
+//------------------------------------------------------------------------------
+static int qlabel_track_line (
+  qlabel_t *                            pLabel,
+  uint32_t                              line
+) {
+  int err;
+  size_t length;
+
+  length = qlabel_line_length_at(pLabel, line);
+  while (
+    QP(pLabel)->longest.count != QP(pLabel)->longestFirst &&
+    qlabel_line_length_at(pLabel, QP(pLabel)->longest.pData[QP(pLabel)->longest.count - 1]) < length
+  ) {
+    --QP(pLabel)->longest.count;
+  }
+
+  // Entries dropped from the front are reclaimed once they are most of the array.
+  if (QP(pLabel)->longestFirst > QP(pLabel)->longest.count / 2) {
+    memmove(
+      QP(pLabel)->longest.pData,
+      QP(pLabel)->longest.pData + QP(pLabel)->longestFirst,
+      (QP(pLabel)->longest.count - QP(pLabel)->longestFirst) * sizeof(uint32_t)
+    );
+    QP(pLabel)->longest.count -= QP(pLabel)->longestFirst;
+    QP(pLabel)->longestFirst = 0;
+  }
+  err = qarray_ensure(QW(pLabel)->pAllocator, &QP(pLabel)->longest);
+  if (err) {
+    return err;
+  }
+  QP(pLabel)->longest.pData[QP(pLabel)->longest.count++] = line;
+  return 0;
+}
+
+// Call this before the first line is dropped (or cut), returns whether it was kept as longest.
+//------------------------------------------------------------------------------
+static qbool_t qlabel_untrack_first (
+  qlabel_t *                            pLabel
+) {
+  if (
+    QP(pLabel)->longestFirst != QP(pLabel)->longest.count &&
+    QP(pLabel)->longest.pData[QP(pLabel)->longestFirst] == QP(pLabel)->firstLine
+  ) {
+    ++QP(pLabel)->longestFirst;
+    return QTRUE;
+  }
+  return QFALSE;
+}
+
+// Call this before the last line is continued, since it only gets longer the lines it displaced stay displaced.
+//------------------------------------------------------------------------------
+static void qlabel_untrack_last (
+  qlabel_t *                            pLabel
+) {
+  if (
+    QP(pLabel)->longestFirst != QP(pLabel)->longest.count &&
+    QP(pLabel)->longest.pData[QP(pLabel)->longest.count - 1] == QP(pLabel)->lines.count - 2
+  ) {
+    --QP(pLabel)->longest.count;
+  }
+}
+
+// Forgets the wrapped rows, they will be wrapped again when they are needed.
+//------------------------------------------------------------------------------
+static void qlabel_forget_wraps (
+  qlabel_t *                            pLabel
+) {
+  qarray_clear(&QP(pLabel)->wrapped.lines);
+  qarray_clear(&QP(pLabel)->wrapped.rows);
+}
+
+// Borrowed text is never written to, the label's own contents are left empty meanwhile.
+// Note: Either way, there is no text afterwards - borrowed text is not copied.
+//------------------------------------------------------------------------------
+static void qlabel_release (
+  qlabel_t *                            pLabel
+) {
+  if (!QP(pLabel)->isBorrowed) {
+    qstring_clear(&QP(pLabel)->contents);
+    return;
+  }
+  if (QP(pLabel)->pfnRelease) {
+    QP(pLabel)->pfnRelease(QP(pLabel)->pBorrowed, QP(pLabel)->borrowedLength);
+  }
+  QP(pLabel)->pBorrowed = NULL;
+  QP(pLabel)->borrowedLength = 0;
+  QP(pLabel)->isBorrowed = QFALSE;
+}
+
+//------------------------------------------------------------------------------
+static void qlabel_clear_lines (
+  qlabel_t *                            pLabel
+) {
+  QP(pLabel)->firstByte = 0;
+  qarray_clear(&QP(pLabel)->lines);
+  QP(pLabel)->firstLine = 0;
+  QP(pLabel)->maxLineLength = 0;
+  qarray_clear(&QP(pLabel)->longest);
+  QP(pLabel)->longestFirst = 0;
+  qlabel_forget_wraps(pLabel);
+}
+
+// Borrowed text has to be copied before it can be added to, the offsets into it remain the same.
+//------------------------------------------------------------------------------
+static int qlabel_own (
+  qlabel_t *                            pLabel
+) {
+  int err;
+
+  if (!QP(pLabel)->isBorrowed) {
+    return 0;
+  }
+  err = qstring_assign_n(
+    QW(pLabel)->pAllocator,
+    &QP(pLabel)->contents,
+    QP(pLabel)->pBorrowed,
+    QP(pLabel)->borrowedLength
+  );
+  if (err) {
+    return err;
+  }
+
+  qlabel_release(pLabel);
+  return 0;
+}
+
+// Only lines longer than the width have to be searched for break points, others are a single row.
+// A break after a space is kept for widths from that space up to the next space, any other break only for this width.
+//------------------------------------------------------------------------------
+static int qlabel_wrap_line (
+  qlabel_t *                            pLabel,
+  uint32_t                              line,
+  qextent_t                             width,
+  qlabel_rows_t *                       pRows,
+  qlabel_wrap_line_t *                  pLine
+) {
+  int err;
+  size_t breakLength;
+  size_t skipLength;
+  size_t nextSpace;
+  qlabel_span_t span;
+  char const * pData;
+
+  pData = qlabel_data(pLabel);
+  span.offset = qlabel_lines(pLabel)[line];
+  span.length = qlabel_line_length(pLabel, line);
+  *pLine = (qlabel_wrap_line_t){ 0, 0, QINFINITE };
+  while (span.length > width) {
+
+    // Break after the last space which fits, or within the word if there is none.
+    breakLength = width;
+    skipLength = 0;
+    if (QP(pLabel)->wrap == QWRAP_WORD) {
+      while (breakLength != 0 && pData[span.offset + breakLength] != ' ') {
+        --breakLength;
+      }
+      if (breakLength == 0) {
+        breakLength = width;
+      }
+      else {
+        skipLength = 1;
+      }
+    }
+
+    // Any wider and a later space (or the rest of the line) would fit as well.
+    if (skipLength) {
+      nextSpace = (size_t)width + 1;
+      while (nextSpace < span.length && nextSpace < pLine->maxWidth && pData[span.offset + nextSpace] != ' ') {
+        ++nextSpace;
+      }
+      pLine->minWidth = QMAX(pLine->minWidth, (qextent_t)breakLength);
+      pLine->maxWidth = (qextent_t)QMIN(nextSpace, (size_t)pLine->maxWidth);
+    }
+    else {
+      pLine->minWidth = width;
+      pLine->maxWidth = width + 1;
+    }
+
+    err = qarray_push(QW(pLabel)->pAllocator, pRows, ((qlabel_span_t){ span.offset, breakLength }));
+    if (err) {
+      return err;
+    }
+    ++pLine->rowCount;
+    span.offset += breakLength + skipLength;
+    span.length -= breakLength + skipLength;
+  }
+
+  err = qarray_push(QW(pLabel)->pAllocator, pRows, span);
+  if (err) {
+    return err;
+  }
+  ++pLine->rowCount;
+  pLine->minWidth = QMAX(pLine->minWidth, (qextent_t)span.length);
+  return 0;
+}
+
+// Moves the rows to a new width, rows of lines which break the same way are copied rather than found again.
+//------------------------------------------------------------------------------
+static int qlabel_rewrap (
+  qlabel_t *                            pLabel,
+  qextent_t                             width
+) {
+  int err;
+  uint32_t line;
+  uint32_t row;
+  uint32_t end;
+  qlabel_rows_t rows;
+  qlabel_wrap_line_t * pLine;
+  qlabel_wrap_t * pWrap;
+
+  pWrap = &QP(pLabel)->wrapped;
+  qarray_clear(&pWrap->spareRows);
+  if (pWrap->rows.count > pWrap->spareRows.capacity) {
+    err = qarray_resize(QW(pLabel)->pAllocator, &pWrap->spareRows, pWrap->rows.count);
+    if (err) {
+      return err;
+    }
+  }
+
+  row = 0;
+  for (line = 0; line < pWrap->lines.count; ++line) {
+    pLine = &pWrap->lines.pData[line];
+    end = row + pLine->rowCount;
+    if (width < pLine->minWidth || width >= pLine->maxWidth) {
+      err = qlabel_wrap_line(pLabel, line, width, &pWrap->spareRows, pLine);
+      if (err) {
+        return err;
+      }
+    }
+    else {
+      for (; row != end; ++row) {
+        err = qarray_push(QW(pLabel)->pAllocator, &pWrap->spareRows, pWrap->rows.pData[row]);
+        if (err) {
+          return err;
+        }
+      }
+    }
+    row = end;
+  }
+
+  rows = pWrap->rows;
+  pWrap->rows = pWrap->spareRows;
+  pWrap->spareRows = rows;
+  pWrap->width = width;
+  return 0;
+}
+
+// Brings the rows to the width, and wraps any lines not yet wrapped.
+//------------------------------------------------------------------------------
+static int qlabel_wrap (
+  qlabel_t *                            pLabel,
+  qextent_t                             width,
+  qlabel_wrap_t **                      ppWrap
+) {
+  int err;
+  uint32_t line;
+  qlabel_wrap_t * pWrap;
+
+  // If rewrapping fails part of the way, the lines no longer match the rows, so they are all forgotten.
+  pWrap = &QP(pLabel)->wrapped;
+  width = QMAX(width, 1);
+  if (pWrap->width != width) {
+    err = qlabel_rewrap(pLabel, width);
+    if (err) {
+      qlabel_forget_wraps(pLabel);
+      return err;
+    }
+  }
+
+  // A line is only counted as wrapped once all of its rows are, so a failure can simply be retried.
+  for (line = pWrap->lines.count; line < qlabel_line_count(pLabel); ++line) {
+    err = qarray_ensure(QW(pLabel)->pAllocator, &pWrap->lines);
+    if (err) {
+      return err;
+    }
+    ++pWrap->lines.count;
+    err = qlabel_wrap_line(pLabel, line, width, &pWrap->rows, &pWrap->lines.pData[line]);
+    if (err) {
+      pWrap->rows.count -= pWrap->lines.pData[line].rowCount;
+      --pWrap->lines.count;
+      return err;
+    }
+  }
+
+  *ppWrap = pWrap;
+  return 0;
+}
+
+// Note: FNV-1a, lines are short enough that a simple hash is plenty.
+//------------------------------------------------------------------------------
+static uint64_t qlabel_hash (
+  char const *                          pData,
+  size_t                                n
+) {
+  size_t idx;
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (idx = 0; idx < n; ++idx) {
+    hash = (hash ^ (uint8_t)pData[idx]) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+// Hashes every line, and marks those which differ from the line at the same index before.
+// Only if the lines can be painted in the same place (same count and width) are they compared.
+//------------------------------------------------------------------------------
+static int qlabel_diff_lines (
+  qlabel_t *                            pLabel,
+  qbool_t                               canDiff
+) {
+  int err;
+  uint32_t idx;
+  uint32_t lineCount;
+  uint64_t hash;
+  qlabel_line_t * pState;
+
+  lineCount = qlabel_line_count(pLabel);
+  if (lineCount > QP(pLabel)->lineStates.capacity) {
+    err = qarray_resize(QW(pLabel)->pAllocator, &QP(pLabel)->lineStates, lineCount);
+    if (err) {
+      QP(pLabel)->lineStates.count = 0;
+      QP(pLabel)->repaintAll = QTRUE;
+      return err;
+    }
+  }
+
+  canDiff = QBOOL(canDiff && QP(pLabel)->lineStates.count == lineCount);
+  for (idx = 0; idx < lineCount; ++idx) {
+    pState = &QP(pLabel)->lineStates.pData[idx];
+    hash = qlabel_hash(qlabel_data(pLabel) + qlabel_lines(pLabel)[idx], qlabel_line_length(pLabel, idx));
+    if (!canDiff) {
+      pState->changed = QTRUE;
+      pState->paintedColumn = 0;
+      pState->paintedLength = 0;
+    }
+    else if (pState->hash != hash) {
+      pState->changed = QTRUE;
+    }
+    if (pState->changed) {
+      pState->changedFirst = 0;
+      pState->changedLast = SIZE_MAX;
+    }
+    pState->hash = hash;
+  }
+
+  QP(pLabel)->lineStates.count = lineCount;
+  if (!canDiff) {
+    QP(pLabel)->repaintAll = QTRUE;
+  }
+  return 0;
+}
+
+// Text which was added to or cut from has moved on screen, so it is painted in full.
+//------------------------------------------------------------------------------
+static void qlabel_forget_lines (
+  qlabel_t *                            pLabel
+) {
+  qarray_clear(&QP(pLabel)->lineStates);
+  QP(pLabel)->repaintAll = QTRUE;
+}
+
+// Splits contents from byte begin onwards into lines.
+// Note: If the text before begin did not end in a newline, the new bytes continue that line.
+//------------------------------------------------------------------------------
+static int qlabel_index (
+  qlabel_t *                            pLabel,
+  uint32_t                              begin,
+  qbool_t                               continueLine
+) {
+  int err;
+  uint32_t line;
+  size_t end;
+  qscan_t scan;
+
+  // A continued line loses its end again, and is scanned from its start along with the new bytes.
+  // Otherwise the end of the last line is already where the new text starts.
+  end = qlabel_data_length(pLabel);
+  qscan_init(&scan, begin);
+  if (continueLine) {
+    if (QP(pLabel)->wrapped.lines.count == qlabel_line_count(pLabel)) {
+      QP(pLabel)->wrapped.rows.count -= QP(pLabel)->wrapped.lines.pData[QP(pLabel)->wrapped.lines.count - 1].rowCount;
+      --QP(pLabel)->wrapped.lines.count;
+    }
+    qlabel_untrack_last(pLabel);
+    --QP(pLabel)->lines.count;
+    scan.lineStart = QP(pLabel)->lines.pData[QP(pLabel)->lines.count - 1];
+  }
+  else if (QP(pLabel)->lines.count == QP(pLabel)->firstLine) {
+    err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->lines, scan.lineStart);
+    if (err) {
+      return err;
+    }
+  }
+
+  // The scanner writes line ends straight into the spare capacity, which grows whenever it fills.
+  line = QP(pLabel)->lines.count - 1;
+  while (scan.offset != end) {
+    err = qarray_ensure(QW(pLabel)->pAllocator, &QP(pLabel)->lines);
+    if (err) {
+      return err;
+    }
+    QP(pLabel)->lines.count += (uint32_t)qscan_lines(
+      &scan,
+      qlabel_data(pLabel),
+      end,
+      QP(pLabel)->lines.pData + QP(pLabel)->lines.count,
+      QP(pLabel)->lines.capacity - QP(pLabel)->lines.count
+    );
+  }
+
+  // The text after the last newline is a line as well.
+  if (scan.lineStart != end) {
+    err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->lines, end);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Only the new lines have to be considered for the longest.
+  for (; line + 1 < QP(pLabel)->lines.count; ++line) {
+    err = qlabel_track_line(pLabel, line);
+    if (err) {
+      return err;
+    }
+  }
+
+  qlabel_settle_max(pLabel);
+  return 0;
+}
+
+// Drops the runs before firstByte, and moves the others back by as much.
+//------------------------------------------------------------------------------
+static void qlabel_rebase_runs (
+  qlabel_t *                            pLabel
+) {
+  uint32_t idx;
+  uint32_t count;
+  uint32_t end;
+  qlabel_run_t * pRun;
+
+  count = 0;
+  for (idx = 0; idx < QP(pLabel)->runs.count; ++idx) {
+    pRun = &QP(pLabel)->runs.pData[idx];
+    end = pRun->offset + pRun->length;
+    if (end <= QP(pLabel)->firstByte) {
+      continue;
+    }
+    pRun->offset = QMAX(pRun->offset, QP(pLabel)->firstByte) - QP(pLabel)->firstByte;
+    pRun->length = end - QP(pLabel)->firstByte - pRun->offset;
+    QP(pLabel)->runs.pData[count++] = *pRun;
+  }
+  QP(pLabel)->runs.count = count;
+}
+
+//------------------------------------------------------------------------------
+static void qlabel_compact (
+  qlabel_t *                            pLabel
+) {
+  uint32_t idx;
+  uint32_t offsetCount;
+  uint32_t firstLine;
+
+  // Moving the text means moving every offset into it as well (and the lines kept as longest).
+  firstLine = QP(pLabel)->firstLine;
+  // Note: Borrowed text cannot be moved, so it is only ever skipped over.
+  if (!QP(pLabel)->isBorrowed && QP(pLabel)->firstByte > QP(pLabel)->contents.length / 2) {
+    qstring_erase_front(&QP(pLabel)->contents, QP(pLabel)->firstByte);
+    qlabel_rebase_runs(pLabel);
+    offsetCount = QP(pLabel)->lines.count - QP(pLabel)->firstLine;
+    for (idx = 0; idx < offsetCount; ++idx) {
+      QP(pLabel)->lines.pData[idx] = QP(pLabel)->lines.pData[QP(pLabel)->firstLine + idx] - QP(pLabel)->firstByte;
+    }
+    QP(pLabel)->firstByte = 0;
+    QP(pLabel)->lines.count = offsetCount;
+    QP(pLabel)->firstLine = 0;
+  }
+  else if (QP(pLabel)->firstLine > QP(pLabel)->lines.count / 2) {
+    memmove(
+      QP(pLabel)->lines.pData,
+      qlabel_lines(pLabel),
+      (QP(pLabel)->lines.count - QP(pLabel)->firstLine) * sizeof(size_t)
+    );
+    QP(pLabel)->lines.count -= QP(pLabel)->firstLine;
+    QP(pLabel)->firstLine = 0;
+  }
+  if (firstLine != QP(pLabel)->firstLine) {
+    for (idx = QP(pLabel)->longestFirst; idx < QP(pLabel)->longest.count; ++idx) {
+      QP(pLabel)->longest.pData[idx] -= firstLine;
+    }
+  }
+}
+
+// Copies the text into the label's own contents, the label is left as it was on failure.
+// Note: The label's own contents were left empty while borrowing, so they can be assigned.
+//       Borrowed text is released only once the text is replaced, as the new text may be a part of it.
+//------------------------------------------------------------------------------
+static int qlabel_assign_text (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n,
+  qbool_t *                             pWasBorrowed
+) {
+  *pWasBorrowed = QP(pLabel)->isBorrowed;
+  return qstring_assign_n(
+    QW(pLabel)->pAllocator,
+    &QP(pLabel)->contents,
+    text,
+    n
+  );
+}
+
+// Call once the label's own contents hold the new text (and runs), which replace all of the old text.
+// Note: Borrowed text is released only now, as the new text may have been made from it.
+//------------------------------------------------------------------------------
+static int qlabel_replace_text (
+  qlabel_t *                            pLabel,
+  qbool_t                               wasBorrowed,
+  qbool_t                               sameRuns
+) {
+  int err;
+  uint32_t oldLineCount;
+  size_t oldMaxLineLength;
+
+  if (wasBorrowed) {
+    qlabel_release(pLabel);
+  }
+
+  // Forget about all previous lines.
+  oldLineCount = qlabel_line_count(pLabel);
+  oldMaxLineLength = QP(pLabel)->maxLineLength;
+  qlabel_clear_lines(pLabel);
+
+  // Construct the line offsets for the whole string, since everything is new.
+  err = qlabel_index(pLabel, 0, QFALSE);
+  if (err) {
+    return err;
+  }
+
+  // Lines stay in place as long as there are as many, the longest is just as long, and styles did not move.
+  err = qlabel_diff_lines(
+    pLabel,
+    QBOOL(sameRuns && qlabel_line_count(pLabel) == oldLineCount && QP(pLabel)->maxLineLength == oldMaxLineLength)
+  );
+  if (err) {
+    return err;
+  }
+
+  // If we succeeded, the label has to be painted again, and only measured if its size could have changed.
+  // Note: Wrapped text is measured in rows, which any change to the text can move.
+  if (QP(pLabel)->wrap == QWRAP_NONE && qlabel_line_count(pLabel) == oldLineCount && QP(pLabel)->maxLineLength == oldMaxLineLength) {
+    qwidget_mark_dirty(pLabel);
+  }
+  else {
+    qwidget_update_geometry(pLabel);
+  }
+  return qwidget_emit(pLabel, set_text, qstring_data(&QP(pLabel)->contents), QP(pLabel)->contents.length);
+}
+
+// Overwrites a single line of text with text of the same length, in place.
+// Nothing has to be measured or split into lines, and only the bytes which differ are painted.
+// Note: Returns QFALSE if the text does not qualify, then it has to be replaced as usual.
+//------------------------------------------------------------------------------
+static qbool_t qlabel_patch_text (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n
+) {
+  size_t first;
+  size_t last;
+  char * pData;
+  qlabel_line_t * pState;
+
+  if (
+    QP(pLabel)->isBorrowed || QP(pLabel)->wrap != QWRAP_NONE || QP(pLabel)->runs.count != 0 ||
+    QP(pLabel)->firstByte != 0 || QP(pLabel)->contents.length != n || n == 0 ||
+    qlabel_line_count(pLabel) != 1 || QP(pLabel)->lineStates.count != 1 ||
+    qstring_data(&QP(pLabel)->contents)[n - 1] == '\n' || memchr(text, '\n', n)
+  ) {
+    return QFALSE;
+  }
+
+  pData = qstring_data(&QP(pLabel)->contents);
+  for (first = 0; first < n && pData[first] == text[first]; ++first);
+  if (first == n) {
+    return QTRUE;
+  }
+  for (last = n; pData[last - 1] == text[last - 1]; --last);
+  memcpy(pData + first, text + first, last - first);
+
+  // Bytes changed since the last paint are still to be painted as well.
+  pState = &QP(pLabel)->lineStates.pData[0];
+  if (pState->changed) {
+    pState->changedFirst = QMIN(pState->changedFirst, first);
+    pState->changedLast = QMAX(pState->changedLast, last);
+  }
+  else {
+    pState->changed = QTRUE;
+    pState->changedFirst = first;
+    pState->changedLast = last;
+  }
+  pState->hash = qlabel_hash(pData, n);
+  qwidget_mark_dirty(pLabel);
+  return QTRUE;
+}
+
+// Plain text has no runs, returns whether it had none before (so that the lines may be diffed).
+//------------------------------------------------------------------------------
+static qbool_t qlabel_clear_runs (
+  qlabel_t *                            pLabel
+) {
+  qbool_t const hadNone = QBOOL(QP(pLabel)->runs.count == 0);
+  qarray_clear(&QP(pLabel)->runs);
+  return hadNone;
+}
+
+// Makes the pending runs current, returns whether they are the same as the current ones were.
+//------------------------------------------------------------------------------
+static qbool_t qlabel_swap_runs (
+  qlabel_t *                            pLabel
+) {
+  qbool_t sameRuns;
+  qlabel_run_t * pData;
+  uint32_t count;
+  uint32_t capacity;
+
+  sameRuns = QBOOL(
+    QP(pLabel)->runs.count == QP(pLabel)->pendingRuns.count &&
+    (QP(pLabel)->runs.count == 0 || memcmp(QP(pLabel)->runs.pData, QP(pLabel)->pendingRuns.pData, QP(pLabel)->runs.count * sizeof(qlabel_run_t)) == 0)
+  );
+
+  // Note: The arrays are distinct (anonymous) types, so they are swapped field by field.
+  pData = QP(pLabel)->runs.pData;
+  count = QP(pLabel)->runs.count;
+  capacity = QP(pLabel)->runs.capacity;
+  QP(pLabel)->runs.pData = QP(pLabel)->pendingRuns.pData;
+  QP(pLabel)->runs.count = QP(pLabel)->pendingRuns.count;
+  QP(pLabel)->runs.capacity = QP(pLabel)->pendingRuns.capacity;
+  QP(pLabel)->pendingRuns.pData = pData;
+  QP(pLabel)->pendingRuns.count = count;
+  QP(pLabel)->pendingRuns.capacity = capacity;
+  qarray_clear(&QP(pLabel)->pendingRuns);
+  return sameRuns;
+}
+
+// Reads the markup, either recording its runs (pOut is NULL), or writing its text to pOut.
+// The runs are found first, so that malformed markup is rejected before any text is overwritten.
+// Note: The text is never longer than the markup, so writing it over the markup itself is fine.
+//------------------------------------------------------------------------------
+static int qlabel_parse_markup (
+  qlabel_t *                            pLabel,
+  char const *                          markup,
+  size_t                                n,
+  char *                                pOut,
+  size_t *                              pLength
+) {
+  int err;
+  size_t idx;
+  size_t length;
+  qbool_t isOpen;
+  qlabel_run_t run;
+
+  idx = 0;
+  length = 0;
+  isOpen = QFALSE;
+  run.offset = 0;
+  run.style = 0;
+  while (idx < n) {
+
+    // Doubled braces are the braces themselves.
+    if ((markup[idx] == '{' || markup[idx] == '}') && idx + 1 < n && markup[idx + 1] == markup[idx]) {
+      if (pOut) {
+        pOut[length] = markup[idx];
+      }
+      ++length;
+      idx += 2;
+    }
+
+    // An opening brace is followed by the style id, and a colon.
+    else if (markup[idx] == '{') {
+      if (isOpen) {
+        return EINVAL;
+      }
+      run.style = 0;
+      for (++idx; idx < n && markup[idx] >= '0' && markup[idx] <= '9'; ++idx) {
+        run.style = run.style * 10 + (uint32_t)(markup[idx] - '0');
+        if (run.style >= QLABEL_STYLE_COUNT) {
+          return EINVAL;
+        }
+      }
+      if (idx >= n || markup[idx] != ':' || markup[idx - 1] == '{') {
+        return EINVAL;
+      }
+      run.offset = (uint32_t)length;
+      isOpen = QTRUE;
+      ++idx;
+    }
+
+    // Empty spans are simply dropped.
+    else if (markup[idx] == '}') {
+      if (!isOpen) {
+        return EINVAL;
+      }
+      run.length = (uint32_t)length - run.offset;
+      if (!pOut && run.length) {
+        err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->pendingRuns, run);
+        if (err) {
+          return err;
+        }
+      }
+      isOpen = QFALSE;
+      ++idx;
+    }
+
+    else {
+      if (pOut) {
+        pOut[length] = markup[idx];
+      }
+      ++length;
+      ++idx;
+    }
+  }
+
+  if (isOpen) {
+    return EINVAL;
+  }
+  *pLength = length;
+  return 0;
+}
+
+// Shows a number, which is padded with spaces on the left to width (so the digits keep their place).
+// Note: The number ends at pEnd, and its first character is at pEnd - *pLength.
+//------------------------------------------------------------------------------
+static int qlabel_set_number (
+  qlabel_t *                            pLabel,
+  char *                                pEnd,
+  size_t                                length,
+  qextent_t                             width
+) {
+  while (length < width) {
+    *(pEnd - ++length) = ' ';
+  }
+  if (qlabel_patch_text(pLabel, pEnd - length, length)) {
+    return qwidget_emit(pLabel, set_text, qstring_data(&QP(pLabel)->contents), length);
+  }
+  return qlabel_set_text_n(pLabel, pEnd - length, length);
+}
+
+// Writes the decimal digits of value backwards from pEnd, returns how many were written.
+//------------------------------------------------------------------------------
+static size_t qlabel_format_digits (
+  char *                                pEnd,
+  uint64_t                              value,
+  size_t                                minimum
+) {
+  size_t length = 0;
+  do {
+    *(pEnd - ++length) = (char)('0' + value % 10);
+    value /= 10;
+  } while (value || length < minimum);
+  return length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Label Functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Clears the columns [first, last) of a row, relative to the inner region.
+//------------------------------------------------------------------------------
+static int qlabel_clear_span (
+  qlabel_t *                            pLabel,
+  qpainter_t *                          pPainter,
+  qextent_t                             row,
+  qextent_t                             first,
+  qextent_t                             last
+) {
+  qregion_t region;
+
+  if (first >= last) {
+    return 0;
+  }
+  region = qregion(
+    QW(pLabel)->innerRegion.coord.column + (qoffset_t)first,
+    QW(pLabel)->innerRegion.coord.row + (qoffset_t)row,
+    1,
+    last - first
+  );
+  return qpainter_clear(pPainter, &region);
+}
+
+// Paints data[offset, offset + n) from the coordinate, switching styles where the runs start and end.
+// Note: The runs are in order, so the first one reaching into the text is found by a binary search.
+//------------------------------------------------------------------------------
+static int qlabel_paint_text (
+  qlabel_t *                            pLabel,
+  qpainter_t *                          pPainter,
+  qcoord_t                              coord,
+  size_t                                offset,
+  size_t                                n
+) {
+  int err;
+  uint32_t low;
+  uint32_t high;
+  uint32_t middle;
+  size_t end;
+  size_t next;
+  qstyle_t style;
+  qlabel_run_t const * pRun;
+
+  if (QP(pLabel)->runs.count == 0 && QP(pLabel)->styles[0] == QSTYLE_NONE) {
+    return qpainter_paint(pPainter, &coord, qlabel_data(pLabel) + offset, n);
+  }
+
+  low = 0;
+  high = QP(pLabel)->runs.count;
+  while (low < high) {
+    middle = low + (high - low) / 2;
+    pRun = &QP(pLabel)->runs.pData[middle];
+    if ((size_t)pRun->offset + pRun->length <= offset) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  // Text between the runs is painted in style 0.
+  err = 0;
+  end = offset + n;
+  while (!err && offset < end) {
+    pRun = (low < QP(pLabel)->runs.count) ? &QP(pLabel)->runs.pData[low] : NULL;
+    if (pRun && pRun->offset <= offset) {
+      style = QP(pLabel)->styles[pRun->style];
+      next = QMIN(end, (size_t)pRun->offset + pRun->length);
+      ++low;
+    }
+    else {
+      style = QP(pLabel)->styles[0];
+      next = pRun ? QMIN(end, (size_t)pRun->offset) : end;
+    }
+    qpainter_set_style(pPainter, style);
+    err = qpainter_paint(pPainter, &coord, qlabel_data(pLabel) + offset, next - offset);
+    coord.column += (qoffset_t)(next - offset);
+    offset = next;
+  }
+
+  qpainter_set_style(pPainter, QSTYLE_NONE);
+  return err;
+}
 
 //------------------------------------------------------------------------------
 QRECALC(
@@ -48,24 +1044,68 @@ QRECALC(
   qregion_t const *                     pRegion
 ) {
 
+  int err;
+  uint32_t rowCount;
+  qlabel_wrap_t * pWrap;
+
   // If the actual region has not changed, we can simply ignore the recalculate step.
   // This means a recalculate was requested, but that none of the math would change.
   if (qregion_equal(&QW(pLabel)->outerRegion, pRegion)) {
     return 0;
   }
 
-  // TODO: Handle calculations for word wrapping, which can dynamically change the content size.
-  //       For now, just assume no dynamic content size changes based on print region.
+  // Wrapped text has as many rows as the width requires.
+  rowCount = qlabel_line_count(pLabel);
+  if (QP(pLabel)->wrap != QWRAP_NONE) {
+    err = qlabel_wrap(pLabel, pRegion->bounds.columns, &pWrap);
+    if (err) {
+      return err;
+    }
+    rowCount = pWrap->rows.count;
+  }
+
+  // Measuring reported the rows at the last width, so a width which wraps differently has to be measured again.
+  if (QP(pLabel)->wrap != QWRAP_NONE && rowCount != QP(pLabel)->measuredRows) {
+    qwidget_update_geometry(pLabel);
+  }
+
   qwidget_mark_state(pLabel, QSTATE_DIRTY_BIT);
+  QP(pLabel)->repaintAll = QTRUE;
   QW(pLabel)->contentBounds  = qbounds(
-    QMIN(QP(pLabel)->lines.count, pRegion->bounds.rows),
-    QP(pLabel)->maxLineLength
+    QMIN(rowCount, pRegion->bounds.rows),
+    (qextent_t)QMIN(QP(pLabel)->maxLineLength, (size_t)QINFINITE)
   );
   QW(pLabel)->outerRegion    = *pRegion;
 
   return 0;
 }
 
+//------------------------------------------------------------------------------
+QMEASURE(
+  qlabel_measure,
+  qlabel_t *                            pLabel,
+  qbounds_t *                           pHint
+) {
+  int err;
+  qlabel_wrap_t * pWrap;
+
+  // Wrapped text needs as many rows as it wrapped to at the last width (until it was laid out once).
+  QP(pLabel)->measuredRows = qlabel_line_count(pLabel);
+  if (QP(pLabel)->wrap != QWRAP_NONE && QP(pLabel)->wrapped.width != 0) {
+    err = qlabel_wrap(pLabel, QP(pLabel)->wrapped.width, &pWrap);
+    if (err) {
+      return err;
+    }
+    QP(pLabel)->measuredRows = pWrap->rows.count;
+  }
+
+  *pHint = qbounds(
+    QP(pLabel)->measuredRows,
+    (qextent_t)QMIN(QP(pLabel)->maxLineLength, (size_t)QINFINITE)
+  );
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 QPAINTER(
   qlabel_paint,
@@ -76,21 +1116,50 @@ QPAINTER(
   uint32_t idx;
   size_t lineLength;
   size_t printedLength;
-  size_t columnOffset;
+  qextent_t columnOffset;
   size_t stringOffset;
-  size_t lineOffset;
-  size_t rowOffset;
-  size_t rowCount;
+  qextent_t lineOffset;
+  qextent_t rowOffset;
+  qextent_t rowCount;
+  qextent_t firstRow;
+  qextent_t lastRow;
+  int64_t clipTop;
+  int64_t clipBottom;
+  uint32_t lineCount;
+  size_t first;
+  size_t last;
+  size_t const * pLines;
   char const * pString;
   qcoord_t printCoord;
+  qregion_t clip;
+  qlabel_wrap_t * pWrap;
+  qlabel_line_t * pState;
+  qbool_t partial;
+  qpainter_state_t paintedState;
+
+  if (!qwidget_is_dirty(pLabel)) {
+    return 0;
+  }
+
+  // When wrapping, the rows of the text at this width are painted rather than its lines.
+  pWrap = NULL;
+  pLines = qlabel_lines(pLabel);
+  lineCount = qlabel_line_count(pLabel);
+  if (QP(pLabel)->wrap != QWRAP_NONE) {
+    err = qlabel_wrap(pLabel, QW(pLabel)->outerRegion.bounds.columns, &pWrap);
+    if (err) {
+      return err;
+    }
+    lineCount = pWrap->rows.count;
+  }
 
   // Calculate the inner content region (union of contentBounds and outerRegion)
   // Calculate the row/column offset based on content length and alignment.
   // Note that this is for the entire printable region, not for an individual line.
   {
     QW(pLabel)->contentBounds  = qbounds(
-      QP(pLabel)->lines.count,
-      QP(pLabel)->maxLineLength
+      lineCount,
+      (qextent_t)QMIN(QP(pLabel)->maxLineLength, (size_t)QINFINITE)
     );
     QW(pLabel)->innerRegion.coord = QW(pLabel)->outerRegion.coord;
     QW(pLabel)->innerRegion.bounds = qbounds(
@@ -103,11 +1172,11 @@ QPAINTER(
         break;
 
       case QALIGN_CENTER_BIT:
-        QW(pLabel)->innerRegion.coord.column += (QW(pLabel)->outerRegion.bounds.columns - QW(pLabel)->innerRegion.bounds.columns) / 2;
+        QW(pLabel)->innerRegion.coord.column += (qoffset_t)((QW(pLabel)->outerRegion.bounds.columns - QW(pLabel)->innerRegion.bounds.columns) / 2);
         break;
 
       case QALIGN_RIGHT_BIT:
-        QW(pLabel)->innerRegion.coord.column += QW(pLabel)->outerRegion.bounds.columns - QW(pLabel)->innerRegion.bounds.columns;
+        QW(pLabel)->innerRegion.coord.column += (qoffset_t)(QW(pLabel)->outerRegion.bounds.columns - QW(pLabel)->innerRegion.bounds.columns);
         break;
 
       default:
@@ -119,11 +1188,11 @@ QPAINTER(
         break;
 
       case QALIGN_MIDDLE_BIT:
-        QW(pLabel)->innerRegion.coord.row += (QW(pLabel)->outerRegion.bounds.rows - QW(pLabel)->innerRegion.bounds.rows) / 2;
+        QW(pLabel)->innerRegion.coord.row += (qoffset_t)((QW(pLabel)->outerRegion.bounds.rows - QW(pLabel)->innerRegion.bounds.rows) / 2);
         break;
 
       case QALIGN_BOTTOM_BIT:
-        QW(pLabel)->innerRegion.coord.row += QW(pLabel)->outerRegion.bounds.rows - QW(pLabel)->innerRegion.bounds.rows;
+        QW(pLabel)->innerRegion.coord.row += (qoffset_t)(QW(pLabel)->outerRegion.bounds.rows - QW(pLabel)->innerRegion.bounds.rows);
         break;
 
       default:
@@ -131,13 +1200,25 @@ QPAINTER(
     }
   }
 
-  // Clear the outer region.
-  err = qpainter_clear(
-    pPainter,
-    &QW(pLabel)->outerRegion
+  // What was painted is still on screen if nothing moved, then only changed lines are painted.
+  // Note: The painter state differs when painting through a different window (e.g. when scrolled).
+  qpainter_save(pPainter, &paintedState);
+  partial = QBOOL(
+    !QP(pLabel)->repaintAll && !pWrap && !qwidget_needs_repaint(pLabel) &&
+    QP(pLabel)->lineStates.count == lineCount &&
+    qcoord_equal(&paintedState.origin, &QP(pLabel)->paintedState.origin) &&
+    qregion_equal(&paintedState.clip, &QP(pLabel)->paintedState.clip)
   );
-  if (err) {
-    return err;
+
+  // Clear the outer region.
+  if (!partial) {
+    err = qpainter_clear(
+      pPainter,
+      &QW(pLabel)->outerRegion
+    );
+    if (err) {
+      return err;
+    }
   }
 
   // Calculate the number of lines that will be cut off due to a small outerRegion.
@@ -146,32 +1227,32 @@ QPAINTER(
     case QALIGN_TOP_BIT:
       rowOffset = 0;
       lineOffset = 0;
-      rowCount = QMIN(QW(pLabel)->innerRegion.bounds.rows, QP(pLabel)->lines.count);
+      rowCount = QMIN(QW(pLabel)->innerRegion.bounds.rows, lineCount);
       break;
 
     case QALIGN_MIDDLE_BIT:
-      if (QW(pLabel)->innerRegion.bounds.rows < QP(pLabel)->lines.count) {
+      if (QW(pLabel)->innerRegion.bounds.rows < lineCount) {
         rowOffset = 0;
-        lineOffset = (QP(pLabel)->lines.count - QW(pLabel)->innerRegion.bounds.rows) / 2;
+        lineOffset = (lineCount - QW(pLabel)->innerRegion.bounds.rows) / 2;
         rowCount = QW(pLabel)->innerRegion.bounds.rows;
       }
       else {
-        rowOffset = (QW(pLabel)->innerRegion.bounds.rows - QP(pLabel)->lines.count) / 2;
+        rowOffset = (QW(pLabel)->innerRegion.bounds.rows - lineCount) / 2;
         lineOffset = 0;
-        rowCount = QP(pLabel)->lines.count;
+        rowCount = lineCount;
       }
       break;
 
     case QALIGN_BOTTOM_BIT:
-      if (QW(pLabel)->innerRegion.bounds.rows < QP(pLabel)->lines.count) {
+      if (QW(pLabel)->innerRegion.bounds.rows < lineCount) {
         rowOffset = 0;
-        lineOffset = QP(pLabel)->lines.count - QW(pLabel)->innerRegion.bounds.rows;
+        lineOffset = lineCount - QW(pLabel)->innerRegion.bounds.rows;
         rowCount = QW(pLabel)->innerRegion.bounds.rows;
       }
       else {
-        rowOffset = QW(pLabel)->innerRegion.bounds.rows - QP(pLabel)->lines.count;
+        rowOffset = QW(pLabel)->innerRegion.bounds.rows - lineCount;
         lineOffset = 0;
-        rowCount = QP(pLabel)->lines.count;
+        rowCount = lineCount;
       }
       break;
 
@@ -179,13 +1260,31 @@ QPAINTER(
       return ENOTSUP;
   }
 
-  // Print each of the lines
-  pString = QP(pLabel)->contents->data;
-  for (idx = 0; idx < rowCount; ++idx) {
+  // Rows outside of the clip (e.g. scrolled out of view) would not be painted, so they're skipped.
+  clip = qpainter_get_clip(pPainter);
+  clipTop = (int64_t)clip.coord.row - (QW(pLabel)->innerRegion.coord.row + (qoffset_t)rowOffset);
+  clipBottom = clipTop + clip.bounds.rows;
+  firstRow = (qextent_t)QMIN(QMAX(clipTop, 0), (int64_t)rowCount);
+  lastRow = (qextent_t)QMIN(QMAX(clipBottom, (int64_t)firstRow), (int64_t)rowCount);
 
-    // Grab the current line length (excluding the newline).
+  // Print each of the lines, starting after those which were cut off above.
+  // Any line can be found from its offset, so the lines cut off are never visited.
+  for (idx = firstRow; idx < lastRow; ++idx) {
+    pState = (pWrap || idx + lineOffset >= QP(pLabel)->lineStates.count) ? NULL : &QP(pLabel)->lineStates.pData[idx + lineOffset];
+    if (partial && !pState->changed) {
+      continue;
+    }
+
+    // Grab the current line and its length (excluding the newline).
     // Using this, we will calculate the printedLength which is visible lineLength.
-    lineLength = QP(pLabel)->lines.pData[idx + lineOffset];
+    if (pWrap) {
+      pString = qlabel_data(pLabel) + pWrap->rows.pData[idx + lineOffset].offset;
+      lineLength = pWrap->rows.pData[idx + lineOffset].length;
+    }
+    else {
+      pString = qlabel_data(pLabel) + pLines[idx + lineOffset];
+      lineLength = qlabel_line_length(pLabel, idx + lineOffset);
+    }
     printedLength = QMIN(lineLength, QW(pLabel)->innerRegion.bounds.columns);
 
     // If the printedLength is smaller than the lineLength, we have to cut some content.
@@ -202,7 +1301,7 @@ QPAINTER(
           stringOffset = (lineLength - printedLength) / 2;
         }
         else {
-          columnOffset = (QW(pLabel)->innerRegion.bounds.columns - lineLength) / 2;
+          columnOffset = (qextent_t)((QW(pLabel)->innerRegion.bounds.columns - lineLength) / 2);
           stringOffset = 0;
         }
         break;
@@ -213,7 +1312,7 @@ QPAINTER(
           stringOffset = (lineLength - printedLength);
         }
         else {
-          columnOffset = (QW(pLabel)->innerRegion.bounds.columns - lineLength);
+          columnOffset = (qextent_t)(QW(pLabel)->innerRegion.bounds.columns - lineLength);
           stringOffset = 0;
         }
         break;
@@ -222,25 +1321,77 @@ QPAINTER(
         return EFAULT;
     }
 
+    // A line painted in the same place only has to paint the bytes which changed (e.g. some digits).
+    if (partial && pState->paintedColumn == columnOffset && pState->paintedLength == printedLength) {
+      first = QMAX(pState->changedFirst, stringOffset);
+      last = QMIN(pState->changedLast, stringOffset + printedLength);
+      if (first < last) {
+        printCoord = qcoord(
+          QW(pLabel)->innerRegion.coord.column + (qoffset_t)(columnOffset + first - stringOffset),
+          QW(pLabel)->innerRegion.coord.row + (qoffset_t)(rowOffset + idx)
+        );
+        err = qlabel_paint_text(
+          pLabel,
+          pPainter,
+          printCoord,
+          (size_t)(pString - qlabel_data(pLabel)) + first,
+          last - first
+        );
+        if (err) {
+          return err;
+        }
+      }
+      pState->changed = QFALSE;
+      continue;
+    }
+
+    // A changed line only has to clear what it painted before, where it does not paint now.
+    if (partial) {
+      err = qlabel_clear_span(
+        pLabel,
+        pPainter,
+        rowOffset + idx,
+        pState->paintedColumn,
+        QMIN(pState->paintedColumn + pState->paintedLength, columnOffset)
+      );
+      if (!err) {
+        err = qlabel_clear_span(
+          pLabel,
+          pPainter,
+          rowOffset + idx,
+          QMAX(pState->paintedColumn, columnOffset + (qextent_t)printedLength),
+          pState->paintedColumn + pState->paintedLength
+        );
+      }
+      if (err) {
+        return err;
+      }
+    }
+
     // Move to the ideal innerRegion offset and print the string.
-    // Offset the pString pointer by the full lineLength (+1 for newline) for next line.
     printCoord = qcoord(
-      QW(pLabel)->innerRegion.coord.column + columnOffset,
-      QW(pLabel)->innerRegion.coord.row + rowOffset + idx
+      QW(pLabel)->innerRegion.coord.column + (qoffset_t)columnOffset,
+      QW(pLabel)->innerRegion.coord.row + (qoffset_t)(rowOffset + idx)
     );
-    err = qpainter_paint(
+    err = qlabel_paint_text(
+      pLabel,
       pPainter,
-      &printCoord,
-      pString + stringOffset,
+      printCoord,
+      (size_t)(pString - qlabel_data(pLabel)) + stringOffset,
       printedLength
     );
     if (err) {
       return err;
     }
-
-    pString += lineLength + 1;
+    if (pState) {
+      pState->changed = QFALSE;
+      pState->paintedColumn = columnOffset;
+      pState->paintedLength = (qextent_t)printedLength;
+    }
   }
 
+  QP(pLabel)->repaintAll = QFALSE;
+  QP(pLabel)->paintedState = paintedState;
   qwidget_unmark_dirty(pLabel);
   return 0;
 }
@@ -261,6 +1412,8 @@ int QCURSESCALL qcreate_label (
   widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_label);
   widgetConfig.pfnRecalculate = QRECALC_PTR(qlabel_recalculate);
   widgetConfig.pfnPaint       = QPAINTER_PTR(qlabel_paint);
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = QMEASURE_PTR(qlabel_measure);
 
   // Allocate the terminal UI application.
   err = qcreate_widget(
@@ -273,7 +1426,7 @@ int QCURSESCALL qcreate_label (
 
   // Grab the application private implementation pointer.
   QP(label)->alignment = QALIGN_MIDDLE_BIT | QALIGN_CENTER_BIT;
-  qlt3alloc_init(QW(label)->pAllocator, &QP(label)->allocator);
+  QP(label)->repaintAll = QTRUE;
 
   // Return the application to the caller.
   *pLabel = label;
@@ -284,8 +1437,17 @@ int QCURSESCALL qcreate_label (
 void QCURSESCALL qdestroy_label (
   qlabel_t *                            pLabel
 ) {
-  lt3_pstring_deinit(&QP(pLabel)->allocator.instance, QP(pLabel)->contents);
-  qdestroy_widget(pLabel);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->wrapped.lines);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->wrapped.rows);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->wrapped.spareRows);
+  qlabel_release(pLabel);
+  qstring_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->contents);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->lines);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->longest);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->runs);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->pendingRuns);
+  qarray_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->lineStates);
+  qfree(QW(pLabel)->pAllocator, pLabel);
 }
 
 //------------------------------------------------------------------------------
@@ -295,10 +1457,10 @@ int QCURSESCALL qlabel_set_align (
 ) {
   if (QP(pLabel)->alignment != alignment) {
     QP(pLabel)->alignment = alignment;
+    QP(pLabel)->repaintAll = QTRUE;
     qwidget_mark_dirty(pLabel);
   }
-  qwidget_emit(pLabel, set_align, alignment);
-  return 0;
+  return qwidget_emit(pLabel, set_align, alignment);
 }
 
 //------------------------------------------------------------------------------
@@ -308,6 +1470,52 @@ qalign_t QCURSESCALL qlabel_get_align (
   return QP(pLabel)->alignment;
 }
 
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_wrap (
+  qlabel_t *                            pLabel,
+  qwrap_t                               wrap
+) {
+  if (QP(pLabel)->wrap != wrap) {
+    QP(pLabel)->wrap = wrap;
+    QP(pLabel)->repaintAll = QTRUE;
+    qlabel_forget_wraps(pLabel);
+    qwidget_update_geometry(pLabel);
+  }
+  return qwidget_emit(pLabel, set_wrap, wrap);
+}
+
+//------------------------------------------------------------------------------
+qwrap_t QCURSESCALL qlabel_get_wrap (
+  qlabel_t *                            pLabel
+) {
+  return QP(pLabel)->wrap;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_style (
+  qlabel_t *                            pLabel,
+  uint32_t                              id,
+  qstyle_t                              style
+) {
+  if (id >= QLABEL_STYLE_COUNT) {
+    return EINVAL;
+  }
+  if (QP(pLabel)->styles[id] != style) {
+    QP(pLabel)->styles[id] = style;
+    QP(pLabel)->repaintAll = QTRUE;
+    qwidget_mark_dirty(pLabel);
+  }
+  return qwidget_emit(pLabel, set_style, id, style);
+}
+
+//------------------------------------------------------------------------------
+qstyle_t QCURSESCALL qlabel_get_style (
+  qlabel_t *                            pLabel,
+  uint32_t                              id
+) {
+  return (id < QLABEL_STYLE_COUNT) ? QP(pLabel)->styles[id] : QSTYLE_NONE;
+}
+
 //------------------------------------------------------------------------------
 int QCURSESCALL qlabel_set_text (
   qlabel_t *                            pLabel,
@@ -327,21 +1535,276 @@ int QCURSESCALL qlabel_set_text_n (
   size_t                                n
 ) {
   int err;
-  size_t idx;
-  size_t last;
-  char * pData;
-  size_t lineLength;
-  size_t maxLineLength;
-  lt3_pstring_t pString;
+  qbool_t wasBorrowed;
+
+  err = qlabel_assign_text(pLabel, text, n, &wasBorrowed);
+  if (err) {
+    return err;
+  }
+
+  return qlabel_replace_text(pLabel, wasBorrowed, qlabel_clear_runs(pLabel));
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_rich_text (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n,
+  qlabel_run_t const *                  pRuns,
+  uint32_t                              runCount
+) {
+  int err;
+  uint32_t idx;
+  uint32_t end;
+  qbool_t wasBorrowed;
+
+  // The runs are checked and copied before the text is touched, so a bad run leaves the label as it was.
+  end = 0;
+  qarray_clear(&QP(pLabel)->pendingRuns);
+  for (idx = 0; idx < runCount; ++idx) {
+    if (
+      pRuns[idx].offset < end || pRuns[idx].style >= QLABEL_STYLE_COUNT ||
+      pRuns[idx].offset > n || pRuns[idx].length > n - pRuns[idx].offset
+    ) {
+      return EINVAL;
+    }
+    end = pRuns[idx].offset + pRuns[idx].length;
+    if (!pRuns[idx].length) {
+      continue;
+    }
+    err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->pendingRuns, pRuns[idx]);
+    if (err) {
+      return err;
+    }
+  }
+
+  err = qlabel_assign_text(pLabel, text, n, &wasBorrowed);
+  if (err) {
+    return err;
+  }
+
+  return qlabel_replace_text(pLabel, wasBorrowed, qlabel_swap_runs(pLabel));
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_markup (
+  qlabel_t *                            pLabel,
+  char const *                          markup
+) {
+  return qlabel_set_markup_n(
+    pLabel,
+    markup,
+    strlen(markup)
+  );
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_markup_n (
+  qlabel_t *                            pLabel,
+  char const *                          markup,
+  size_t                                n
+) {
+  int err;
+  size_t length;
+  qbool_t wasBorrowed;
+
+  if (n >= UINT32_MAX) {
+    return ERANGE;
+  }
+
+  // The runs are found first, which is all that can fail once there is room for the text.
+  qarray_clear(&QP(pLabel)->pendingRuns);
+  err = qlabel_parse_markup(pLabel, markup, n, NULL, &length);
+  if (err) {
+    return err;
+  }
+  wasBorrowed = QP(pLabel)->isBorrowed;
+  err = qstring_reserve(QW(pLabel)->pAllocator, &QP(pLabel)->contents, length);
+  if (err) {
+    return err;
+  }
+
+  // Note: The markup may be the label's own text, which is long enough that reserving did not move it.
+  qlabel_parse_markup(pLabel, markup, n, qstring_data(&QP(pLabel)->contents), &length);
+  qstring_data(&QP(pLabel)->contents)[length] = '\0';
+  QP(pLabel)->contents.length = (uint32_t)length;
+
+  return qlabel_replace_text(pLabel, wasBorrowed, qlabel_swap_runs(pLabel));
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_printf (
+  qlabel_t *                            pLabel,
+  char const *                          format,
+  ...
+) {
+  int err;
+  va_list args;
+
+  va_start(args, format);
+  err = qlabel_vprintf(pLabel, format, args);
+  va_end(args);
+
+  return err;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_vprintf (
+  qlabel_t *                            pLabel,
+  char const *                          format,
+  va_list                               args
+) {
+  int err;
+  qbool_t wasBorrowed;
+
+  // The text is formatted into the label's own contents, which are left as they were on failure.
+  wasBorrowed = QP(pLabel)->isBorrowed;
+  err = qstring_vprintf(
+    QW(pLabel)->pAllocator,
+    &QP(pLabel)->contents,
+    format,
+    args
+  );
+  if (err) {
+    return err;
+  }
+
+  return qlabel_replace_text(pLabel, wasBorrowed, qlabel_clear_runs(pLabel));
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_int (
+  qlabel_t *                            pLabel,
+  int64_t                               value,
+  qextent_t                             width
+) {
+  size_t length;
+  uint64_t magnitude;
+  char buffer[QLABEL_NUMBER_WIDTH];
+
+  if (width > QLABEL_NUMBER_WIDTH) {
+    return EINVAL;
+  }
+
+  // Note: The magnitude is taken unsigned, so that INT64_MIN does not overflow.
+  magnitude = (value < 0) ? (0 - (uint64_t)value) : (uint64_t)value;
+  length = qlabel_format_digits(buffer + sizeof(buffer), magnitude, 1);
+  if (value < 0) {
+    buffer[sizeof(buffer) - ++length] = '-';
+  }
+
+  return qlabel_set_number(pLabel, buffer + sizeof(buffer), length, width);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_double (
+  qlabel_t *                            pLabel,
+  double                                value,
+  uint32_t                              precision,
+  qextent_t                             width
+) {
+  static uint64_t const scales[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+  };
+  int written;
+  size_t length;
+  double magnitude;
+  uint64_t fixed;
+  char buffer[QLABEL_NUMBER_WIDTH];
+
+  if (width > QLABEL_NUMBER_WIDTH) {
+    return EINVAL;
+  }
+
+  // Most values are rounded to a fixed-point integer, and printed as two integers.
+  // Note: The comparison is false for NaN, which is left to snprintf along with huge values.
+  magnitude = (value < 0) ? -value : value;
+  if (precision < sizeof(scales) / sizeof(scales[0]) && magnitude * (double)scales[precision] < 1e18) {
+    fixed = (uint64_t)(magnitude * (double)scales[precision] + 0.5);
+    length = 0;
+    if (precision) {
+      length += qlabel_format_digits(buffer + sizeof(buffer), fixed % scales[precision], precision);
+      buffer[sizeof(buffer) - ++length] = '.';
+    }
+    length += qlabel_format_digits(buffer + sizeof(buffer) - length, fixed / scales[precision], 1);
+    if (value < 0 && fixed) {
+      buffer[sizeof(buffer) - ++length] = '-';
+    }
+    return qlabel_set_number(pLabel, buffer + sizeof(buffer), length, width);
+  }
+
+  written = snprintf(buffer, sizeof(buffer), "%*.*f", (int)width, (int)precision, value);
+  if (written < 0 || (size_t)written >= sizeof(buffer)) {
+    return qlabel_printf(pLabel, "%*.*f", (int)width, (int)precision, value);
+  }
+  return qlabel_set_number(pLabel, buffer + written, (size_t)written, width);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_text_ref (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n,
+  qlabel_release_pfn                    pfnRelease
+) {
+  int err;
+
+  if (n >= UINT32_MAX) {
+    return ERANGE;
+  }
+
+  // The label's own storage is given up, so the text is not held twice.
+  qlabel_release(pLabel);
+  qstring_deinit(QW(pLabel)->pAllocator, &QP(pLabel)->contents);
+  QP(pLabel)->pBorrowed = text;
+  QP(pLabel)->borrowedLength = (uint32_t)n;
+  QP(pLabel)->isBorrowed = QTRUE;
+  QP(pLabel)->pfnRelease = pfnRelease;
+  qlabel_clear_lines(pLabel);
+  qlabel_clear_runs(pLabel);
+  qlabel_forget_lines(pLabel);
+
+  // The lines are found in place, nothing is copied.
+  err = qlabel_index(pLabel, 0, QFALSE);
+  if (err) {
+    return err;
+  }
+
+  qwidget_update_geometry(pLabel);
+  return qwidget_emit(pLabel, set_text, text, n);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_append_text (
+  qlabel_t *                            pLabel,
+  char const *                          text
+) {
+  return qlabel_append_text_n(
+    pLabel,
+    text,
+    strlen(text)
+  );
+}
 
-  // We will be using the string a lot here, so grab a pointer.
-  // Mostly this is just for code cleanliness - makes things simpler.
-  pString = QP(pLabel)->contents;
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_append_text_n (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n
+) {
+  int err;
+  qbool_t continueLine;
+  uint32_t begin;
 
-  // Attempt to set the string inside the label.
-  err = lt3_pstring_assign_cstr_n(
-    &QP(pLabel)->allocator.instance,
-    &pString,
+  // Attempt to add the new text after the existing text.
+  err = qlabel_own(pLabel);
+  if (err) {
+    return err;
+  }
+  begin = QP(pLabel)->contents.length;
+  err = qstring_append_n(
+    QW(pLabel)->pAllocator,
+    &QP(pLabel)->contents,
     text,
     n
   );
@@ -349,47 +1812,85 @@ int QCURSESCALL qlabel_set_text_n (
     return err;
   }
 
-  // Now that we have a new label string, grab it for ease of use.
-  // In this case, we want to avoid constantly grabbing the string pointer.
-  // There is some cost to this, since the string can be either embedded or external.
-  pData = pString->data;
-  QP(pLabel)->contents = pString;
-  qarray_clear(&QP(pLabel)->lines);
+  // An unterminated last line is continued by the new text, rather than starting a new line.
+  continueLine = QBOOL(begin != QP(pLabel)->firstByte && qstring_data(&QP(pLabel)->contents)[begin - 1] != '\n');
 
-  // Construct the string views into the raw data as relative offsets.
-  // These are the places where a newline occurs so we can calculate alignment later.
-  maxLineLength = 0;
-  for (last = 0, idx = 0; idx < pString->length; ++idx) {
-    if (pData[idx] == '\n') {
-      lineLength = idx - last;
-      if (lineLength > maxLineLength) {
-        maxLineLength = lineLength;
-      }
-      err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->lines, lineLength);
-      if (err) {
-        return err;
-      }
-      last = idx + 1;
-    }
+  // Only the new bytes have to be split into lines.
+  qlabel_forget_lines(pLabel);
+  err = qlabel_index(pLabel, begin, continueLine);
+  if (err) {
+    return err;
+  }
+
+  qwidget_update_geometry(pLabel);
+  return qwidget_emit(pLabel, append_text, qstring_data(&QP(pLabel)->contents) + begin, n);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_truncate_lines (
+  qlabel_t *                            pLabel,
+  size_t                                n
+) {
+  size_t const * pLines;
+
+  // The bytes of the dropped lines (and their newlines) are simply the distance between their starts.
+  n = QMIN(n, qlabel_line_count(pLabel));
+  if (n == 0) {
+    return 0;
+  }
+  pLines = qlabel_lines(pLabel);
+  return qlabel_truncate_text(pLabel, pLines[n] - pLines[0]);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_truncate_text (
+  qlabel_t *                            pLabel,
+  size_t                                n
+) {
+  size_t first;
+  qbool_t wasLongest;
+
+  // Dropping all of the text is simply resetting it.
+  n = QMIN(n, qlabel_text_length(pLabel));
+  if (n == 0) {
+    return 0;
   }
-  if (idx != last) {
-    lineLength = idx - last;
-    if (lineLength > maxLineLength) {
-      maxLineLength = lineLength;
+  if (n == qlabel_text_length(pLabel)) {
+    qlabel_release(pLabel);
+    qlabel_clear_lines(pLabel);
+    qlabel_clear_runs(pLabel);
+  }
+
+  // Otherwise, drop whole lines and move the start of the line which the cut falls within.
+  else {
+    first = QP(pLabel)->firstByte + n;
+    while (QP(pLabel)->lines.pData[QP(pLabel)->firstLine + 1] <= first) {
+      (void)qlabel_untrack_first(pLabel);
+      ++QP(pLabel)->firstLine;
     }
-    err = qarray_push(QW(pLabel)->pAllocator, &QP(pLabel)->lines, lineLength);
-    if (err) {
-      return err;
+
+    // The cut line is only kept if it is still at least as long as any line after it.
+    // Note: Untracking it freed the entry in front, so this can't fail.
+    wasLongest = qlabel_untrack_first(pLabel);
+    QP(pLabel)->lines.pData[QP(pLabel)->firstLine] = first;
+    if (
+      wasLongest &&
+      (
+        QP(pLabel)->longestFirst == QP(pLabel)->longest.count ||
+        qlabel_line_length(pLabel, 0) >= qlabel_line_length_at(pLabel, QP(pLabel)->longest.pData[QP(pLabel)->longestFirst])
+      )
+    ) {
+      QP(pLabel)->longest.pData[--QP(pLabel)->longestFirst] = QP(pLabel)->firstLine;
     }
+    QP(pLabel)->firstByte = (uint32_t)first;
+    qlabel_compact(pLabel);
+    qlabel_forget_wraps(pLabel);
+    qlabel_settle_max(pLabel);
   }
 
-  // Assign the line statistics.
-  QP(pLabel)->maxLineLength = maxLineLength;
-
-  // If we succeeded, we should mark the widget as dirty.
-  qwidget_mark_dirty(pLabel);
-  qwidget_emit(pLabel, set_text, pData, n);
-  return 0;
+  qlabel_forget_lines(pLabel);
+  qwidget_update_geometry(pLabel);
+  return qwidget_emit(pLabel, truncate_text, n);
 }
 
 #ifdef    __cplusplus
@@ -18,6 +18,7 @@
 
 #include "qcurses.h"
 #include "qwidget.h"
+#include <stdarg.h>
 
 #ifdef    __cplusplus
 extern "C" {
@@ -27,12 +28,46 @@ extern "C" {
 // Label Definition
 ////////////////////////////////////////////////////////////////////////////////
 
-// TODO: margin, indent, wordwrap mode (qwrap_t?).
+// How many styles a label holds, runs of text refer to them by index.
+//------------------------------------------------------------------------------
+#define QLABEL_STYLE_COUNT              16
+
+// The widest a number shown by qlabel_set_int() or qlabel_set_double() may be padded to.
+//------------------------------------------------------------------------------
+#define QLABEL_NUMBER_WIDTH             64
+
+QDECLARE_STRUCT(qlabel_run_t);
+
+// Called with the text given to qlabel_set_text_ref() once the label no longer refers to it.
+//------------------------------------------------------------------------------
+typedef void (QCURSESPTR *qlabel_release_pfn)(char const *, size_t);
+
+// How lines longer than the label is wide are broken into several rows.
+//------------------------------------------------------------------------------
+enum qwrap_t {
+  QWRAP_NONE,           // Lines are cut off according to the alignment.
+  QWRAP_WORD,           // Lines break at the last space that fits, or within a word too long to fit.
+  QWRAP_CHARACTER       // Lines break at exactly the label width.
+};
+
+// A part of the text painted in one of the label's styles, text outside of any run uses style 0.
+//------------------------------------------------------------------------------
+struct qlabel_run_t {
+  uint32_t                              offset;
+  uint32_t                              length;
+  uint32_t                              style;          // Less than QLABEL_STYLE_COUNT.
+};
+
+// TODO: margin, indent.
 //------------------------------------------------------------------------------
 QWIDGET_BEGIN(qlabel_t)
   QWIDGET_SIGNALS_BEGIN
     QSIGNAL(set_align, qalign_t);
+    QSIGNAL(set_wrap, qwrap_t);
+    QSIGNAL(set_style, uint32_t id, qstyle_t style);
     QSIGNAL(set_text, char const *, size_t n);
+    QSIGNAL(append_text, char const *, size_t n);
+    QSIGNAL(truncate_text, size_t n);
   QWIDGET_SIGNALS_END
 QWIDGET_END
 
@@ -62,6 +97,33 @@ qalign_t QCURSESCALL qlabel_get_align (
   qlabel_t *                            pLabel
 );
 
+// The rows are wrapped when the label is first laid out at a width, and are kept for later use.
+// Note: The size hint has as many rows as the text wrapped to at the last width, and the unwrapped width.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_wrap (
+  qlabel_t *                            pLabel,
+  qwrap_t                               wrap
+);
+
+//------------------------------------------------------------------------------
+qwrap_t QCURSESCALL qlabel_get_wrap (
+  qlabel_t *                            pLabel
+);
+
+// Every style starts out as QSTYLE_NONE.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_style (
+  qlabel_t *                            pLabel,
+  uint32_t                              id,
+  qstyle_t                              style
+);
+
+//------------------------------------------------------------------------------
+qstyle_t QCURSESCALL qlabel_get_style (
+  qlabel_t *                            pLabel,
+  uint32_t                              id
+);
+
 //------------------------------------------------------------------------------
 int QCURSESCALL qlabel_set_text (
   qlabel_t *                            pLabel,
@@ -79,6 +141,113 @@ int QCURSESCALL qlabel_set_text_n (
 #define qlabel_set_text_k(pLabel, text)                                         \
   qlabel_set_text_n(pLabel, text, sizeof(text) - 1)
 
+// Shows the text with the runs painted in their styles, runs must be in order and must not overlap.
+// Note: Text set any other way has no runs, though appended text keeps those already there.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_rich_text (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n,
+  qlabel_run_t const *                  pRuns,
+  uint32_t                              runCount
+);
+
+// Shows the text, where "{id:text}" paints text in the style id (e.g. "Build {1:failed} in 3s").
+// The markup is parsed into runs once, "{{" and "}}" stand for literal braces. Spans do not nest.
+// Note: Returns EINVAL for malformed markup, and leaves the label as it was.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_markup (
+  qlabel_t *                            pLabel,
+  char const *                          markup
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_markup_n (
+  qlabel_t *                            pLabel,
+  char const *                          markup,
+  size_t                                n
+);
+
+// Formats the text straight into the label's own storage, which is reused between calls.
+// Note: The arguments must not refer to the label's current text.
+//       If formatting fails, the label keeps its text.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_printf (
+  qlabel_t *                            pLabel,
+  char const *                          format,
+  ...
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_vprintf (
+  qlabel_t *                            pLabel,
+  char const *                          format,
+  va_list                               args
+);
+
+// Shows the number padded with spaces on the left to width (or 0 for no padding), without printf.
+// While the text keeps its length (e.g. a counter of fixed width), only the digits which changed are painted.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_int (
+  qlabel_t *                            pLabel,
+  int64_t                               value,
+  qextent_t                             width
+);
+
+// Shows the number with precision digits after the decimal point, padded like qlabel_set_int().
+// Note: Precisions over 9, NaN, infinities and magnitudes of 1e18 (scaled) or more go through snprintf.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_double (
+  qlabel_t *                            pLabel,
+  double                                value,
+  uint32_t                              precision,
+  qextent_t                             width
+);
+
+// Shows the text without copying it, the text must stay unchanged until pfnRelease is called.
+// That happens when the text is replaced, the label is destroyed, or text is appended (which copies it).
+// Note: pfnRelease may be NULL for text which outlives the label, such as string literals.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_set_text_ref (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n,
+  qlabel_release_pfn                    pfnRelease
+);
+
+// Adds text after the current text, only the new text is split into lines.
+// Note: Without a trailing newline, the last line is continued by the next append.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_append_text (
+  qlabel_t *                            pLabel,
+  char const *                          text
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_append_text_n (
+  qlabel_t *                            pLabel,
+  char const *                          text,
+  size_t                                n
+);
+
+//------------------------------------------------------------------------------
+#define qlabel_append_text_k(pLabel, text)                                      \
+  qlabel_append_text_n(pLabel, text, sizeof(text) - 1)
+
+// Drops the first n lines (or all of them, if there are fewer).
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_truncate_lines (
+  qlabel_t *                            pLabel,
+  size_t                                n
+);
+
+// Drops the first n bytes of text, which may shorten the first remaining line.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlabel_truncate_text (
+  qlabel_t *                            pLabel,
+  size_t                                n
+);
+
 #ifdef    __cplusplus
 }
 #endif // __cplusplus
@@ -15,203 +15,360 @@
  ******************************************************************************/
 
 #include "qlayout.h"
+#include "qpainter.h"
+#include <stdlib.h>
 
-// TODO: Support element stretching, margins, layout properties.
+// TODO: Support margins and spacing between elements.
 ////////////////////////////////////////////////////////////////////////////////
 // Layout Implementations
 ////////////////////////////////////////////////////////////////////////////////
 
-struct qlayout_element_t;
+// Note: The extents are scratch space for arranging, measured along the layout axis.
+//------------------------------------------------------------------------------
 typedef struct qlayout_element_t {
-  struct qlayout_element_t *     pNext;
-  struct qlayout_element_t *     pPrevious;
-  qwidget_t *                    pWidget;
+  qwidget_t *                           pWidget;
   int                                   stretch;
+  qextent_t                             minimum;
+  qextent_t                             maximum;
+  qextent_t                             extent;
+  qregion_t                             region;         // The region last given to the widget.
 } qlayout_element_t;
 
+// Scratch space for growing, the capacity / weight is the level at which an element reaches its maximum.
+//------------------------------------------------------------------------------
+typedef struct qlayout_level_t {
+  uint64_t                              capacity;
+  uint64_t                              weight;
+  uint32_t                              index;
+} qlayout_level_t;
+
+// Which of the elements receive any space beyond the preferred extents.
+typedef enum qlayout_growth_t {
+  QLAYOUT_GROWTH_NONE,
+  QLAYOUT_GROWTH_GROWABLE,      // Any element with QPOLICY_GROW_BIT, evenly.
+  QLAYOUT_GROWTH_EXPANDING,     // Only elements with QPOLICY_EXPAND_BIT, evenly.
+  QLAYOUT_GROWTH_STRETCHED      // Only elements with a stretch factor, by stretch.
+} qlayout_growth_t;
+
+//------------------------------------------------------------------------------
+// Note: The arrangement is only redone when the region or a size hint changes.
 //------------------------------------------------------------------------------
 struct QPIMPL_NAME(qlayout_t) {
-  qlayout_element_t *            pWidgetsFirst;
-  qlayout_element_t *            pWidgetsLast;
-  qlayout_format_t               layoutFormat;
-  size_t                                widgetCount;
+  QDEFINE_ARRAY(qlayout_element_t)      elements;
+  QDEFINE_ARRAY(qlayout_level_t)        levels;
+  qlayout_format_t                      layoutFormat;
+  qregion_t                             arrangedRegion;
+  qbool_t                               arrangeStale;
 };
 
 //------------------------------------------------------------------------------
-static int __qlayout_reacalculate_vertical (
-  qlayout_t *                    pLayout,
-  qregion_t const *              pRegion
+QDEFINE_EMITTER(set_format, qlayout_format_t);
+
+//------------------------------------------------------------------------------
+static inline qlayout_element_t * qlayout_begin (
+  qlayout_t const *              pLayout
 ) {
-  int err;
-  qlayout_element_t * pElement;
-  qregion_t subRegion;
-  size_t boundsIncrement;
-  size_t boundsRemaining;
-
-  // Given this information, we can split the widget into regions.
-  boundsIncrement = pRegion->bounds.rows / QP(pLayout)->widgetCount;
-  boundsRemaining = pRegion->bounds.rows - (boundsIncrement * QP(pLayout)->widgetCount);
-  subRegion = qregion(
-    pRegion->coord.column,
-    pRegion->coord.row,
-    boundsIncrement,
-    pRegion->bounds.columns
-  );
+  return QP(pLayout)->elements.pData;
+}
 
-  // Calculate the region information per-widget
-  pElement = QP(pLayout)->pWidgetsFirst;
-  while (pElement) {
+//------------------------------------------------------------------------------
+static inline qlayout_element_t * qlayout_end (
+  qlayout_t const *              pLayout
+) {
+  return QP(pLayout)->elements.pData + QP(pLayout)->elements.count;
+}
 
-    // If this is the last widget, we should add the extraneous bounds.
-    if (!pElement->pNext) {
-      subRegion.bounds.rows += boundsRemaining;
-    }
+//------------------------------------------------------------------------------
+static inline qbool_t qlayout_is_vertical (
+  qlayout_format_t               format
+) {
+  return format == QLAYOUT_VERTICAL || format == QLAYOUT_VERTICAL_REVERSE;
+}
 
-    // Recalculate the next widget in the bunch.
-    err = qwidget_recalculate(pElement->pWidget, &subRegion);
-    if (err) {
-      return err;
-    }
+//------------------------------------------------------------------------------
+static inline qbool_t qlayout_is_reverse (
+  qlayout_format_t               format
+) {
+  return format == QLAYOUT_VERTICAL_REVERSE || format == QLAYOUT_HORIZONTAL_REVERSE;
+}
 
-    // Advance the sub-region to the next widget.
-    subRegion.coord.row += boundsIncrement;
-    pElement = pElement->pNext;
+//------------------------------------------------------------------------------
+static inline qextent_t qlayout_main_extent (
+  qlayout_format_t               format,
+  qbounds_t const *              pBounds
+) {
+  return qlayout_is_vertical(format) ? pBounds->rows : pBounds->columns;
+}
 
-  }
+//------------------------------------------------------------------------------
+static inline qextent_t qlayout_cross_extent (
+  qlayout_format_t               format,
+  qbounds_t const *              pBounds
+) {
+  return qlayout_is_vertical(format) ? pBounds->columns : pBounds->rows;
+}
 
-  return 0;
+//------------------------------------------------------------------------------
+static inline uint64_t qlayout_growth_weight (
+  qlayout_element_t const *      pElement,
+  qlayout_growth_t               growth
+) {
+  if (pElement->extent >= pElement->maximum) {
+    return 0;
+  }
+  switch (growth) {
+    case QLAYOUT_GROWTH_GROWABLE:
+      return 1;
+    case QLAYOUT_GROWTH_EXPANDING:
+      return (pElement->pWidget->sizePolicy & QPOLICY_EXPAND_BIT) ? 1 : 0;
+    case QLAYOUT_GROWTH_STRETCHED:
+      return pElement->stretch > 0 ? (uint64_t)pElement->stretch : 0;
+    default:
+      return 0;
+  }
 }
 
+// Measures the elements (through their cached hints) and limits them by their policies.
+// Returns the sum of the preferred extents, and the classes of elements that can grow.
 //------------------------------------------------------------------------------
-static int __qlayout_reacalculate_vertical_reverse (
+static int qlayout_gather (
   qlayout_t *                    pLayout,
-  qregion_t const *              pRegion
+  uint64_t *                     pPreferred,
+  uint64_t *                     pShrinkable,
+  qlayout_growth_t *             pGrowth
 ) {
   int err;
+  qpolicy_t policy;
+  qbounds_t hint;
+  qextent_t preferred;
   qlayout_element_t * pElement;
-  qregion_t subRegion;
-  size_t boundsIncrement;
-  size_t boundsRemaining;
-
-  // Given this information, we can split the widget into regions.
-  boundsIncrement = pRegion->bounds.rows / QP(pLayout)->widgetCount;
-  boundsRemaining = pRegion->bounds.rows - (boundsIncrement * QP(pLayout)->widgetCount);
-  subRegion = qregion(
-    pRegion->coord.column,
-    pRegion->coord.row,
-    boundsIncrement,
-    pRegion->bounds.columns
-  );
+  qlayout_format_t format;
 
-  // Calculate the region information per-widget
-  pElement = QP(pLayout)->pWidgetsLast;
-  while (pElement) {
+  format = QP(pLayout)->layoutFormat;
+  *pPreferred = 0;
+  *pShrinkable = 0;
+  *pGrowth = QLAYOUT_GROWTH_NONE;
 
-    // If this is the last widget, we should add the extraneous bounds.
-    if (!pElement->pPrevious) {
-      subRegion.bounds.rows += boundsRemaining;
-    }
-
-    // Recalculate the next widget in the bunch.
-    err = qwidget_recalculate(pElement->pWidget, &subRegion);
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    err = qwidget_size_hint(pElement->pWidget, &hint);
     if (err) {
       return err;
     }
 
-    // Advance the sub-region to the next widget.
-    subRegion.coord.row += boundsIncrement;
-    pElement = pElement->pPrevious;
-
+    // An element may only leave its preferred extent in the directions the policy allows.
+    policy = pElement->pWidget->sizePolicy;
+    pElement->minimum = qlayout_main_extent(format, &pElement->pWidget->minimumBounds);
+    pElement->maximum = qlayout_main_extent(format, &pElement->pWidget->maximumBounds);
+    preferred = (policy & QPOLICY_IGNORE_BIT) ? pElement->minimum : qlayout_main_extent(format, &hint);
+    if (!(policy & QPOLICY_SHRINK_BIT)) {
+      pElement->minimum = preferred;
+    }
+    if (!(policy & QPOLICY_GROW_BIT)) {
+      pElement->maximum = preferred;
+    }
+    pElement->extent = preferred;
+
+    *pPreferred += preferred;
+    *pShrinkable += preferred - pElement->minimum;
+    if (pElement->extent < pElement->maximum) {
+      if (pElement->stretch > 0) {
+        *pGrowth = QLAYOUT_GROWTH_STRETCHED;
+      }
+      else if ((policy & QPOLICY_EXPAND_BIT) && *pGrowth < QLAYOUT_GROWTH_EXPANDING) {
+        *pGrowth = QLAYOUT_GROWTH_EXPANDING;
+      }
+      else if (*pGrowth < QLAYOUT_GROWTH_GROWABLE) {
+        *pGrowth = QLAYOUT_GROWTH_GROWABLE;
+      }
+    }
   }
 
   return 0;
 }
 
+// Takes the deficit from the elements in proportion to how far each may shrink.
+// Note: Running totals are used for rounding, so the deficit is always met exactly.
 //------------------------------------------------------------------------------
-static int __qlayout_recalculate_horizontal (
+static void qlayout_shrink (
   qlayout_t *                    pLayout,
-  qregion_t const *              pRegion
+  uint64_t                       deficit,
+  uint64_t                       shrinkable
 ) {
-  int err;
+  uint64_t taken;
+  uint64_t share;
+  uint64_t accumulated;
   qlayout_element_t * pElement;
-  qregion_t subRegion;
-  size_t boundsIncrement;
-  size_t boundsRemaining;
-
-  // Given this information, we can split the widget into regions.
-  boundsIncrement = pRegion->bounds.columns / QP(pLayout)->widgetCount;
-  boundsRemaining = pRegion->bounds.columns - (boundsIncrement * QP(pLayout)->widgetCount);
-  subRegion = qregion(
-    pRegion->coord.column,
-    pRegion->coord.row,
-    pRegion->bounds.rows,
-    boundsIncrement
-  );
-
-  // Calculate the region information per-widget
-  pElement = QP(pLayout)->pWidgetsFirst;
-  while (pElement) {
 
-    // If this is the last widget, we should add the extraneous bounds.
-    if (!pElement->pNext) {
-      subRegion.bounds.columns += boundsRemaining;
+  taken = 0;
+  accumulated = 0;
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    if (deficit >= shrinkable) {
+      pElement->extent = pElement->minimum;
+      continue;
     }
+    accumulated += pElement->extent - pElement->minimum;
+    share = deficit * accumulated / shrinkable - taken;
+    taken += share;
+    pElement->extent -= (qextent_t)share;
+  }
+}
 
-    // Recalculate the next widget in the bunch.
-    err = qwidget_recalculate(pElement->pWidget, &subRegion);
+//------------------------------------------------------------------------------
+static int qlayout_compare_levels (
+  void const *                   pLhs,
+  void const *                   pRhs
+) {
+  uint64_t lhs;
+  uint64_t rhs;
+
+  // Compares capacity / weight without dividing (both fit in 32 bits, so the products can't overflow).
+  lhs = ((qlayout_level_t const *)pLhs)->capacity * ((qlayout_level_t const *)pRhs)->weight;
+  rhs = ((qlayout_level_t const *)pRhs)->capacity * ((qlayout_level_t const *)pLhs)->weight;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+// Gives the surplus to the elements of the growth class, weighted and limited by maximum.
+// The elements are visited in the order they reach their maximum, so the ones which do are filled in one pass.
+// Note: The rest can't reach their maximum, they share what's left using running totals for rounding.
+//------------------------------------------------------------------------------
+static int qlayout_grow (
+  qlayout_t *                    pLayout,
+  uint64_t                       surplus,
+  qlayout_growth_t               growth
+) {
+  int err;
+  uint32_t idx;
+  uint64_t given;
+  uint64_t share;
+  uint64_t weight;
+  uint64_t totalWeight;
+  uint64_t accumulated;
+  qlayout_level_t * pLevel;
+  qlayout_element_t * pElement;
+
+  if (QP(pLayout)->levels.capacity < QP(pLayout)->elements.count) {
+    err = qarray_resize(QW(pLayout)->pAllocator, &QP(pLayout)->levels, QP(pLayout)->elements.count);
     if (err) {
       return err;
     }
+  }
+  QP(pLayout)->levels.count = 0;
+  totalWeight = 0;
+  for (idx = 0; idx < QP(pLayout)->elements.count; ++idx) {
+    pElement = &QP(pLayout)->elements.pData[idx];
+    weight = qlayout_growth_weight(pElement, growth);
+    if (!weight) {
+      continue;
+    }
+    pLevel = &QP(pLayout)->levels.pData[QP(pLayout)->levels.count++];
+    pLevel->capacity = pElement->maximum - pElement->extent;
+    pLevel->weight   = weight;
+    pLevel->index    = idx;
+    totalWeight += weight;
+  }
+  if (!totalWeight) {
+    return 0;
+  }
+  qsort(
+    QP(pLayout)->levels.pData,
+    QP(pLayout)->levels.count,
+    sizeof(qlayout_level_t),
+    &qlayout_compare_levels
+  );
 
-    // Advance the sub-region to the next widget.
-    subRegion.coord.column += boundsIncrement;
-    pElement = pElement->pNext;
+  // If an element doesn't reach its maximum at the current level, none of the later ones do.
+  for (idx = 0; idx < QP(pLayout)->levels.count; ++idx) {
+    pLevel = &QP(pLayout)->levels.pData[idx];
+    if (surplus * pLevel->weight / totalWeight < pLevel->capacity) {
+      break;
+    }
+    QP(pLayout)->elements.pData[pLevel->index].extent += (qextent_t)pLevel->capacity;
+    surplus -= pLevel->capacity;
+    totalWeight -= pLevel->weight;
+  }
 
+  // Each share is below the element's capacity, so (with rounding up) it's at most the capacity.
+  // Note: The filled elements are at their maximum now, so they no longer have a weight.
+  given = 0;
+  accumulated = 0;
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout) && totalWeight; ++pElement) {
+    weight = qlayout_growth_weight(pElement, growth);
+    if (!weight) {
+      continue;
+    }
+    accumulated += weight;
+    share = surplus * accumulated / totalWeight - given;
+    given += share;
+    pElement->extent += (qextent_t)share;
   }
 
   return 0;
 }
 
 //------------------------------------------------------------------------------
-static int __qlayout_recalculate_horizontal_reverse (
+static int qlayout_arrange (
   qlayout_t *                    pLayout,
   qregion_t const *              pRegion
 ) {
   int err;
+  uint32_t idx;
+  qbool_t vertical;
+  qextent_t extent;
+  qextent_t available;
+  qextent_t crossExtent;
+  qextent_t crossMaximum;
+  uint64_t preferred;
+  uint64_t shrinkable;
+  qlayout_growth_t growth;
   qlayout_element_t * pElement;
   qregion_t subRegion;
-  size_t boundsIncrement;
-  size_t boundsRemaining;
-
-  // Given this information, we can split the widget into regions.
-  boundsIncrement = pRegion->bounds.columns / QP(pLayout)->widgetCount;
-  boundsRemaining = pRegion->bounds.columns - (boundsIncrement * QP(pLayout)->widgetCount);
-  subRegion = qregion(
-    pRegion->coord.column,
-    pRegion->coord.row,
-    pRegion->bounds.rows,
-    boundsIncrement
-  );
 
-  // Calculate the region information per-widget
-  pElement = QP(pLayout)->pWidgetsLast;
-  while (pElement) {
+  // Measure pass: decide each element's extent along the layout axis.
+  vertical = qlayout_is_vertical(QP(pLayout)->layoutFormat);
+  available = qlayout_main_extent(QP(pLayout)->layoutFormat, &pRegion->bounds);
+  crossExtent = qlayout_cross_extent(QP(pLayout)->layoutFormat, &pRegion->bounds);
+  err = qlayout_gather(pLayout, &preferred, &shrinkable, &growth);
+  if (err) {
+    return err;
+  }
+  if (preferred > available) {
+    qlayout_shrink(pLayout, preferred - available, shrinkable);
+  }
+  else {
+    err = qlayout_grow(pLayout, available - preferred, growth);
+    if (err) {
+      return err;
+    }
+  }
 
-    // If this is the last widget, we should add the extraneous bounds.
-    if (!pElement->pPrevious) {
-      subRegion.bounds.columns += boundsRemaining;
+  // Arrange pass: place the elements in order, clipping any that don't fit.
+  subRegion.coord = pRegion->coord;
+  for (idx = 0; idx < QP(pLayout)->elements.count; ++idx) {
+    pElement = qlayout_is_reverse(QP(pLayout)->layoutFormat)
+      ? &QP(pLayout)->elements.pData[QP(pLayout)->elements.count - idx - 1]
+      : &QP(pLayout)->elements.pData[idx];
+    extent = QMIN(pElement->extent, available);
+    available -= extent;
+    crossMaximum = qlayout_cross_extent(QP(pLayout)->layoutFormat, &pElement->pWidget->maximumBounds);
+    if (vertical) {
+      subRegion.bounds = qbounds(extent, QMIN(crossExtent, crossMaximum));
+    }
+    else {
+      subRegion.bounds = qbounds(QMIN(crossExtent, crossMaximum), extent);
     }
 
-    // Recalculate the next widget in the bunch.
+    pElement->region = subRegion;
     err = qwidget_recalculate(pElement->pWidget, &subRegion);
     if (err) {
       return err;
     }
 
-    // Advance the sub-region to the next widget.
-    subRegion.coord.column += boundsIncrement;
-    pElement = pElement->pPrevious;
-
+    if (vertical) {
+      subRegion.coord.row += (qoffset_t)extent;
+    }
+    else {
+      subRegion.coord.column += (qoffset_t)extent;
+    }
   }
 
   return 0;
@@ -223,34 +380,92 @@ QRECALC(
   qlayout_t *                    pLayout,
   qregion_t const *              pRegion
 ) {
+  int err;
+  qbounds_t hint;
+  qlayout_element_t * pElement;
 
   // Calculate the full widget region information.
   QW(pLayout)->contentBounds = pRegion->bounds;
   QW(pLayout)->outerRegion = *pRegion;
   QW(pLayout)->innerRegion = *pRegion;
 
-  switch (QP(pLayout)->layoutFormat) {
-    case QLAYOUT_VERTICAL:
-      return __qlayout_reacalculate_vertical(
-        pLayout,
-        pRegion
-      );
-    case QLAYOUT_VERTICAL_REVERSE:
-      return __qlayout_reacalculate_vertical_reverse(
-        pLayout,
-        pRegion
-      );
-    case QLAYOUT_HORIZONTAL:
-      return __qlayout_recalculate_horizontal(
-        pLayout,
-        pRegion
-      );
-    case QLAYOUT_HORIZONTAL_REVERSE:
-      return __qlayout_recalculate_horizontal_reverse(
-        pLayout,
-        pRegion
-      );
+  // Our parent has usually measured us already, in which case this is cached.
+  // Otherwise this notices any hint changes below us (marking the arrangement stale).
+  err = qwidget_size_hint(pLayout, &hint);
+  if (err) {
+    return err;
+  }
+
+  // If nothing that the arrangement depends on changed, only dirty children need updating.
+  // They can reuse the region that they were last given.
+  if (!QP(pLayout)->arrangeStale && qregion_equal(&QP(pLayout)->arrangedRegion, pRegion)) {
+    for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+      if (qwidget_is_dirty(pElement->pWidget)) {
+        err = qwidget_recalculate(pElement->pWidget, &pElement->region);
+        if (err) {
+          return err;
+        }
+      }
+    }
   }
+  else {
+    err = qlayout_arrange(pLayout, pRegion);
+    if (err) {
+      return err;
+    }
+  }
+
+  // A child may only learn its hint once placed (e.g. wrapped text at its new width).
+  // Then the arrangement is already out of date, so it is measured and arranged once more.
+  if (qwidget_check_state(pLayout, QSTATE_MEASURE_BIT)) {
+    err = qwidget_size_hint(pLayout, &hint);
+    if (!err) {
+      err = qlayout_arrange(pLayout, pRegion);
+    }
+    if (err) {
+      return err;
+    }
+  }
+  QP(pLayout)->arrangedRegion = *pRegion;
+  QP(pLayout)->arrangeStale = QFALSE;
+  return 0;
+}
+
+// The preferred bounds stack the children's hints along the axis.
+//------------------------------------------------------------------------------
+QMEASURE(
+  qlayout_measure,
+  qlayout_t *                    pLayout,
+  qbounds_t *                    pHint
+) {
+  int err;
+  qbounds_t hint;
+  uint64_t mainExtent;
+  qextent_t crossExtent;
+  qlayout_element_t * pElement;
+
+  mainExtent = 0;
+  crossExtent = 0;
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    err = qwidget_size_hint(pElement->pWidget, &hint);
+    if (err) {
+      return err;
+    }
+    mainExtent += qlayout_main_extent(QP(pLayout)->layoutFormat, &hint);
+    crossExtent = QMAX(crossExtent, qlayout_cross_extent(QP(pLayout)->layoutFormat, &hint));
+  }
+  mainExtent = QMIN(mainExtent, (uint64_t)QINFINITE);
+
+  // Only measured after a hint changed, so the arrangement has to follow.
+  QP(pLayout)->arrangeStale = QTRUE;
+
+  if (qlayout_is_vertical(QP(pLayout)->layoutFormat)) {
+    *pHint = qbounds((qextent_t)mainExtent, crossExtent);
+  }
+  else {
+    *pHint = qbounds(crossExtent, (qextent_t)mainExtent);
+  }
+  return 0;
 }
 
 //------------------------------------------------------------------------------
@@ -260,17 +475,48 @@ QPAINTER(
   qpainter_t *                   pPainter
 ) {
   int err;
+  qregion_t clip;
+  qregion_t overlap;
   qlayout_element_t * pElement;
 
-  // Paint all sub-elements of the layout.
-  pElement = QP(pLayout)->pWidgetsFirst;
-  while (pElement) {
+  // Paint all sub-elements of the layout, except those outside of the clip.
+  // Note: Those stay dirty, and whatever brings them into view repaints them.
+  clip = qpainter_get_clip(pPainter);
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    overlap = qregion_intersect(&pElement->pWidget->outerRegion, &clip);
+    if (qregion_empty(&overlap)) {
+      continue;
+    }
     err = qwidget_paint(pElement->pWidget, pPainter);
     if (err) {
       return err;
     }
-    pElement = pElement->pNext;
   }
+
+  // Clear the dirty state, otherwise child updates would stop propagating here.
+  qwidget_unmark_dirty(pLayout);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QVISIT(
+  qlayout_visit,
+  qlayout_t *                    pLayout,
+  qwidget_visitor_pfn            pfnVisitor,
+  void *                         pUserData
+) {
+  int err;
+  qlayout_element_t * pElement;
+
+  // Visit the sub-elements in the same order that they are painted.
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    err = pfnVisitor(pElement->pWidget, pUserData);
+    if (err) {
+      return err;
+    }
+  }
+
+  return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -294,6 +540,8 @@ int QCURSESCALL qcreate_layout (
   widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_layout);
   widgetConfig.pfnRecalculate = QRECALC_PTR(qlayout_recalculate);
   widgetConfig.pfnPaint       = QPAINTER_PTR(qlayout_paint);
+  widgetConfig.pfnVisit       = QVISIT_PTR(qlayout_visit);
+  widgetConfig.pfnMeasure     = QMEASURE_PTR(qlayout_measure);
 
   // Allocate the terminal UI application.
   err = qcreate_widget(
@@ -306,6 +554,7 @@ int QCURSESCALL qcreate_layout (
 
   // Set the format for the layout.
   QP(layout)->layoutFormat = format;
+  QP(layout)->arrangeStale = QTRUE;
 
   // Return the application to the caller.
   *pLayout = layout;
@@ -316,8 +565,17 @@ int QCURSESCALL qcreate_layout (
 void QCURSESCALL qdestroy_layout (
   qlayout_t *                    pLayout
 ) {
-  // TODO: Add destruction logic.
-  qdestroy_widget(pLayout);
+  qalloc_t const * pAllocator;
+  qlayout_element_t * pElement;
+
+  for (pElement = qlayout_begin(pLayout); pElement != qlayout_end(pLayout); ++pElement) {
+    qdestroy_widget(pElement->pWidget);
+  }
+
+  pAllocator = QW(pLayout)->pAllocator;
+  qarray_deinit(pAllocator, &QP(pLayout)->elements);
+  qarray_deinit(pAllocator, &QP(pLayout)->levels);
+  qfree(pAllocator, pLayout);
 }
 
 //------------------------------------------------------------------------------
@@ -332,51 +590,141 @@ int QCURSESCALL qlayout_set_format (
   qlayout_t const *              pLayout,
   qlayout_format_t               format
 ) {
-  if (QP(pLayout)->layoutFormat != format) {
-    qwidget_mark_dirty(pLayout);
-    qwidget_emit(pLayout, set_format, format);
+  if (QP(pLayout)->layoutFormat == format) {
+    return 0;
   }
   QP(pLayout)->layoutFormat = format;
-  return 0;
+  qwidget_update_geometry(pLayout);
+  return qwidget_emit(pLayout, set_format, format);
+}
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qlayout_widget_count (
+  qlayout_t const *              pLayout
+) {
+  return QP(pLayout)->elements.count;
+}
+
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qlayout_widget_at (
+  qlayout_t const *              pLayout,
+  uint32_t                       idx
+) {
+  if (idx >= QP(pLayout)->elements.count) {
+    return NULL;
+  }
+  return QP(pLayout)->elements.pData[idx].pWidget;
 }
 
 //------------------------------------------------------------------------------
 int QCURSESCALL __qlayout_add_widget (
   qlayout_t *                    pLayout,
   qwidget_t *                    pWidget,
-  int                                   stretch
+  int                            stretch
 ) {
+  return __qlayout_insert_widget(
+    pLayout,
+    pWidget,
+    stretch,
+    QP(pLayout)->elements.count
+  );
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qlayout_insert_widget (
+  qlayout_t *                    pLayout,
+  qwidget_t *                    pWidget,
+  int                            stretch,
+  uint32_t                       idx
+) {
+  int err;
   qlayout_element_t * pElement;
 
-  // Allocate the element so that we can attach it.
-  pElement = (qlayout_element_t *)qallocate(
-    QW(pLayout)->pAllocator,
-    sizeof(qlayout_element_t),
-    1
-  );
-  if (!pElement) {
-    return ENOMEM;
+  if (idx > QP(pLayout)->elements.count) {
+    return ERANGE;
+  }
+  err = qarray_ensure(QW(pLayout)->pAllocator, &QP(pLayout)->elements);
+  if (err) {
+    return err;
   }
 
-  // Initialize the important data members.
+  // Shift the following elements up to open a slot at the index.
+  pElement = &QP(pLayout)->elements.pData[idx];
+  memmove(
+    pElement + 1,
+    pElement,
+    sizeof(qlayout_element_t) * (QP(pLayout)->elements.count - idx)
+  );
+  ++QP(pLayout)->elements.count;
+
+  memset(pElement, 0, sizeof(qlayout_element_t));
   pElement->pWidget = pWidget;
   pElement->stretch = stretch;
-  pElement->pPrevious = NULL;
-  pElement->pNext = NULL;
 
-  // Attach the widget to the layout list.
-  if (!QP(pLayout)->pWidgetsFirst) {
-    QP(pLayout)->pWidgetsFirst = pElement;
-    QP(pLayout)->pWidgetsLast = pElement;
+  qwidget_set_parent(pWidget, pLayout);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qlayout_remove_widget (
+  qlayout_t *                    pLayout,
+  uint32_t                       idx,
+  qwidget_t **                   pWidget
+) {
+  qwidget_t * widget;
+  qlayout_element_t * pElement;
+
+  if (idx >= QP(pLayout)->elements.count) {
+    return ERANGE;
+  }
+
+  // Close the gap left by the element.
+  pElement = &QP(pLayout)->elements.pData[idx];
+  widget = pElement->pWidget;
+  --QP(pLayout)->elements.count;
+  memmove(
+    pElement,
+    pElement + 1,
+    sizeof(qlayout_element_t) * (QP(pLayout)->elements.count - idx)
+  );
+
+  qwidget_set_parent(widget, NULL);
+  if (pWidget) {
+    *pWidget = widget;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlayout_move_widget (
+  qlayout_t *                    pLayout,
+  uint32_t                       from,
+  uint32_t                       to
+) {
+  qlayout_element_t element;
+  qlayout_element_t * pElements;
+
+  if (from >= QP(pLayout)->elements.count || to >= QP(pLayout)->elements.count) {
+    return ERANGE;
+  }
+  if (from == to) {
+    return 0;
+  }
+
+  // Rotate the elements between the two indices by one.
+  pElements = QP(pLayout)->elements.pData;
+  element = pElements[from];
+  if (from < to) {
+    memmove(&pElements[from], &pElements[from + 1], sizeof(qlayout_element_t) * (to - from));
   }
   else {
-    pElement->pPrevious = QP(pLayout)->pWidgetsLast;
-    pElement->pPrevious->pNext = pElement;
-    QP(pLayout)->pWidgetsLast = pElement;
+    memmove(&pElements[to + 1], &pElements[to], sizeof(qlayout_element_t) * (from - to));
   }
+  pElements[to] = element;
 
-  ++QP(pLayout)->widgetCount;
-  QW(pWidget)->pParent = (qwidget_t *)pLayout;
+  // The order of the children is also the painting and tab order.
+  QP(pLayout)->arrangeStale = QTRUE;
+  qwidget_bump_tree_generation();
   qwidget_mark_dirty(pLayout);
   return 0;
-}
\ No newline at end of file
+}
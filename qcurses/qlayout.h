@@ -54,6 +54,7 @@ int QCURSESCALL qcreate_layout (
   qlayout_t **                          pLayout
 );
 
+// Note: The layout owns the widgets added to it, and destroys them along with itself.
 //------------------------------------------------------------------------------
 void QCURSESCALL qdestroy_layout (
   qlayout_t *                           pLayout
@@ -70,6 +71,18 @@ int QCURSESCALL qlayout_set_format (
   qlayout_format_t                      format
 );
 
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qlayout_widget_count (
+  qlayout_t const *                     pLayout
+);
+
+// Returns NULL if the index is out of range.
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qlayout_widget_at (
+  qlayout_t const *                     pLayout,
+  uint32_t                              idx
+);
+
 //------------------------------------------------------------------------------
 int QCURSESCALL __qlayout_add_widget (
   qlayout_t *                           pLayout,
@@ -93,15 +106,41 @@ int QCURSESCALL __qlayout_insert_widget (
   uint32_t                              idx
 );
 
+// Inserts the widget before the index (or at the end, if idx is the widget count).
 //------------------------------------------------------------------------------
 #define qlayout_insert_widget(pLayout, pWidget, stretch, idx)                   \
-  __qlayout_add_widget(                                                         \
+  __qlayout_insert_widget(                                                      \
     pLayout,                                                                    \
     ((qwidget_t *)pWidget),                                                     \
-    stretch                                                                     \
+    stretch,                                                                    \
     idx                                                                         \
   )
 
+//------------------------------------------------------------------------------
+int QCURSESCALL __qlayout_remove_widget (
+  qlayout_t *                           pLayout,
+  uint32_t                              idx,
+  qwidget_t **                          pWidget
+);
+
+// Detaches the widget at the index, ownership of it returns to the caller.
+// Note: pWidget may be NULL, but then the caller must already hold the widget.
+//------------------------------------------------------------------------------
+#define qlayout_remove_widget(pLayout, idx, pWidget)                            \
+  __qlayout_remove_widget(                                                      \
+    pLayout,                                                                    \
+    idx,                                                                        \
+    (qwidget_t **)(pWidget)                                                     \
+  )
+
+// Moves the widget at index from to index to, shifting the widgets in between.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlayout_move_widget (
+  qlayout_t *                           pLayout,
+  uint32_t                              from,
+  uint32_t                              to
+);
+
 #ifdef    __cplusplus
 }
 #endif // __cplusplus
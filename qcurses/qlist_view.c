@@ -0,0 +1,656 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qlist_view.h"
+#include "qpainter.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// List View Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// Marks a row renderer which does not hold any rendered data row.
+#define QLIST_ROW_NONE                  UINT64_MAX
+
+// Note: The text buffer only ever grows, so re-rendering rarely allocates.
+//------------------------------------------------------------------------------
+struct qlist_row_t {
+  qalloc_t const *                      pAllocator;
+  uint64_t                              index;          // The data row last rendered.
+  qbool_t                               stale;          // The data row has changed since.
+  QDEFINE_ARRAY(char)                   text;
+};
+
+// The renderers form a ring with one renderer per visible row.
+// Scrolling moves the head of the ring, so rows that stay visible keep their text.
+//------------------------------------------------------------------------------
+// Note: Unless repaintAll is set, only rows whose renderer is stale (or missed after scrolling) are painted again.
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qlist_view_t) {
+  qlist_source_t                        source;
+  qmodel_t *                            pModel;         // Wrapped by the source, if set.
+  uint64_t                              rowCount;
+  uint64_t                              scrollOffset;
+  uint64_t                              paintedOffset;  // What the screen currently shows.
+  QDEFINE_ARRAY(qlist_row_t)            pool;
+  uint32_t                              poolHead;       // Renderer of the first visible row.
+  qbool_t                               repaintAll;
+};
+
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(scrolled, uint64_t);
+
+//------------------------------------------------------------------------------
+static inline qlist_row_t * qlist_view_row (
+  qlist_view_t *                        pList,
+  uint32_t                              visibleIdx
+) {
+  return &QP(pList)->pool.pData[(QP(pList)->poolHead + visibleIdx) % QP(pList)->pool.count];
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t qlist_view_max_scroll (
+  qlist_view_t const *                  pList
+) {
+  if (QP(pList)->rowCount <= QP(pList)->pool.count) {
+    return 0;
+  }
+  return QP(pList)->rowCount - QP(pList)->pool.count;
+}
+
+//------------------------------------------------------------------------------
+static void qlist_view_forget_rows (
+  qlist_view_t *                        pList
+) {
+  uint32_t idx;
+  for (idx = 0; idx < QP(pList)->pool.count; ++idx) {
+    QP(pList)->pool.pData[idx].index = QLIST_ROW_NONE;
+  }
+  QP(pList)->poolHead = 0;
+  QP(pList)->repaintAll = QTRUE;
+}
+
+// Marks the visible rows within [first, last), so only those are rendered and painted again.
+//------------------------------------------------------------------------------
+static void qlist_view_forget_range (
+  qlist_view_t *                        pList,
+  uint64_t                              first,
+  uint64_t                              last
+) {
+  uint64_t row;
+
+  first = QMAX(first, QP(pList)->scrollOffset);
+  last = QMIN(last, QP(pList)->scrollOffset + QP(pList)->pool.count);
+  if (first >= last) {
+    return;
+  }
+  for (row = first; row < last; ++row) {
+    qlist_view_row(pList, (uint32_t)(row - QP(pList)->scrollOffset))->stale = QTRUE;
+  }
+  qwidget_mark_dirty(pList);
+}
+
+// Moves the view along with rows inserted or removed above it, so that nothing visible changes.
+//------------------------------------------------------------------------------
+static void qlist_view_shift_rows (
+  qlist_view_t *                        pList,
+  uint64_t                              offset,
+  qbool_t                               forward
+) {
+  uint32_t idx;
+  qlist_row_t * pRow;
+
+  for (idx = 0; idx < QP(pList)->pool.count; ++idx) {
+    pRow = &QP(pList)->pool.pData[idx];
+    if (pRow->index != QLIST_ROW_NONE) {
+      pRow->index = forward ? pRow->index + offset : pRow->index - offset;
+    }
+  }
+  if (forward) {
+    QP(pList)->scrollOffset += offset;
+    QP(pList)->paintedOffset += offset;
+  }
+  else {
+    QP(pList)->scrollOffset -= offset;
+    QP(pList)->paintedOffset -= offset;
+  }
+}
+
+// Keeps exactly one renderer per visible row, any text buffers kept are reused.
+//------------------------------------------------------------------------------
+static int qlist_view_resize_pool (
+  qlist_view_t *                        pList,
+  uint32_t                              rows
+) {
+  int err;
+  qlist_row_t row;
+
+  while (QP(pList)->pool.count > rows) {
+    --QP(pList)->pool.count;
+    qarray_deinit(QW(pList)->pAllocator, &QP(pList)->pool.pData[QP(pList)->pool.count].text);
+  }
+  memset(&row, 0, sizeof(row));
+  row.pAllocator = QW(pList)->pAllocator;
+  while (QP(pList)->pool.count < rows) {
+    err = qarray_push(QW(pList)->pAllocator, &QP(pList)->pool, row);
+    if (err) {
+      return err;
+    }
+  }
+
+  // The ring order no longer matches the rows, so start over.
+  qlist_view_forget_rows(pList);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QRECALC(
+  qlist_view_recalculate,
+  qlist_view_t *                        pList,
+  qregion_t const *                     pRegion
+) {
+  int err;
+
+  if (qregion_equal(&QW(pList)->outerRegion, pRegion)) {
+    return 0;
+  }
+
+  qwidget_mark_state(pList, QSTATE_DIRTY_BIT);
+  QP(pList)->repaintAll = QTRUE;
+  QW(pList)->contentBounds = pRegion->bounds;
+  QW(pList)->outerRegion = *pRegion;
+  QW(pList)->innerRegion = *pRegion;
+
+  // Only a change in height changes the number of renderers.
+  if (QP(pList)->pool.count != pRegion->bounds.rows) {
+    err = qlist_view_resize_pool(pList, pRegion->bounds.rows);
+    if (err) {
+      return err;
+    }
+    QP(pList)->scrollOffset = QMIN(QP(pList)->scrollOffset, qlist_view_max_scroll(pList));
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QPAINTER(
+  qlist_view_paint,
+  qlist_view_t *                        pList,
+  qpainter_t *                          pPainter
+) {
+  int err;
+  uint32_t idx;
+  uint64_t dataRow;
+  uint64_t distance;
+  qbool_t repaintAll;
+  qlist_row_t * pRow;
+  qregion_t lineRegion;
+
+  // Whatever was painted before is still on screen, so only stale rows need any work.
+  if (!qwidget_is_dirty(pList)) {
+    return 0;
+  }
+  if (qwidget_needs_repaint(pList)) {
+    QP(pList)->repaintAll = QTRUE;
+  }
+
+  // If the view scrolled, the terminal can move the rows which stay visible.
+  // Their renderers moved with them, so only the rows which scrolled into view miss below.
+  if (!QP(pList)->repaintAll && QP(pList)->paintedOffset != QP(pList)->scrollOffset) {
+    distance = QP(pList)->scrollOffset > QP(pList)->paintedOffset
+      ? QP(pList)->scrollOffset - QP(pList)->paintedOffset
+      : QP(pList)->paintedOffset - QP(pList)->scrollOffset;
+    if (distance < QP(pList)->pool.count) {
+      err = qpainter_scroll(
+        pPainter,
+        &QW(pList)->outerRegion,
+        QP(pList)->scrollOffset > QP(pList)->paintedOffset ? (qoffset_t)distance : -(qoffset_t)distance
+      );
+      if (err == ENOTSUP) {
+        QP(pList)->repaintAll = QTRUE;
+      }
+      else if (err) {
+        return err;
+      }
+    }
+    else {
+      QP(pList)->repaintAll = QTRUE;
+    }
+  }
+  repaintAll = QP(pList)->repaintAll;
+  if (repaintAll) {
+    err = qpainter_clear(pPainter, &QW(pList)->outerRegion);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Only the visible rows are ever rendered, and only if the renderer doesn't hold them.
+  for (idx = 0; idx < QP(pList)->pool.count; ++idx) {
+    dataRow = QP(pList)->scrollOffset + idx;
+    pRow = qlist_view_row(pList, idx);
+    lineRegion = qregion(
+      QW(pList)->outerRegion.coord.column,
+      QW(pList)->outerRegion.coord.row + (qoffset_t)idx,
+      1,
+      QW(pList)->outerRegion.bounds.columns
+    );
+
+    // Rows past the end of the data are blank, clear them if they showed a row before.
+    if (dataRow >= QP(pList)->rowCount) {
+      if (!repaintAll && pRow->index != QLIST_ROW_NONE) {
+        err = qpainter_clear(pPainter, &lineRegion);
+        if (err) {
+          return err;
+        }
+      }
+      pRow->index = QLIST_ROW_NONE;
+      pRow->stale = QFALSE;
+      continue;
+    }
+    if (pRow->index == dataRow && !pRow->stale && !repaintAll) {
+      continue;
+    }
+
+    if (pRow->index != dataRow || pRow->stale) {
+      qarray_clear(&pRow->text);
+      pRow->index = QLIST_ROW_NONE;
+      err = QP(pList)->source.pfnRender(QP(pList)->source.pUserData, dataRow, pRow);
+      if (err) {
+        return err;
+      }
+      pRow->index = dataRow;
+      pRow->stale = QFALSE;
+    }
+    if (!repaintAll) {
+      err = qpainter_clear(pPainter, &lineRegion);
+      if (err) {
+        return err;
+      }
+    }
+
+    err = qpainter_paint(
+      pPainter,
+      &lineRegion.coord,
+      pRow->text.pData,
+      QMIN(pRow->text.count, QW(pList)->outerRegion.bounds.columns)
+    );
+    if (err) {
+      return err;
+    }
+  }
+
+  QP(pList)->paintedOffset = QP(pList)->scrollOffset;
+  QP(pList)->repaintAll = QFALSE;
+  qwidget_unmark_dirty(pList);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t QCURSESCALL qlist_view_model_rows (
+  qlist_view_t *                        pList
+) {
+  return qmodel_row_count(QP(pList)->pModel);
+}
+
+// The list only shows the first column of the model.
+//------------------------------------------------------------------------------
+static int QCURSESCALL qlist_view_model_render (
+  qlist_view_t *                        pList,
+  uint64_t                              row,
+  qlist_row_t *                         pRow
+) {
+  int err;
+  char const * pText;
+  size_t length;
+
+  err = qmodel_data(QP(pList)->pModel, row, 0, &pText, &length);
+  if (err) {
+    return err;
+  }
+  return qlist_row_set_text(pRow, pText, length);
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qlist_view_rows_inserted,
+  qlist_view_t *                        pList,
+  uint64_t                              first,
+  uint64_t                              count
+) {
+  QP(pList)->rowCount += count;
+
+  // Rows inserted above the view push it down, so the same rows stay visible.
+  if (first < QP(pList)->scrollOffset) {
+    qlist_view_shift_rows(pList, count, QTRUE);
+    return qwidget_emit(pList, scrolled, QP(pList)->scrollOffset);
+  }
+
+  qlist_view_forget_range(pList, first, UINT64_MAX);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qlist_view_rows_removed,
+  qlist_view_t *                        pList,
+  uint64_t                              first,
+  uint64_t                              count
+) {
+  uint64_t previousOffset;
+
+  previousOffset = QP(pList)->scrollOffset;
+  QP(pList)->rowCount -= QMIN(count, QP(pList)->rowCount);
+
+  // Rows removed above the view pull it up, rows removed within it change what follows.
+  if (first + count <= QP(pList)->scrollOffset) {
+    qlist_view_shift_rows(pList, count, QFALSE);
+  }
+  else if (first < QP(pList)->scrollOffset) {
+    QP(pList)->scrollOffset = first;
+    qlist_view_forget_rows(pList);
+    qwidget_mark_dirty(pList);
+  }
+  else {
+    qlist_view_forget_range(pList, first, UINT64_MAX);
+  }
+
+  // The last page has to stay full, which may scroll the view up.
+  if (QP(pList)->scrollOffset > qlist_view_max_scroll(pList)) {
+    QP(pList)->scrollOffset = qlist_view_max_scroll(pList);
+    qlist_view_forget_rows(pList);
+    qwidget_mark_dirty(pList);
+  }
+
+  if (QP(pList)->scrollOffset != previousOffset) {
+    return qwidget_emit(pList, scrolled, QP(pList)->scrollOffset);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qlist_view_data_changed,
+  qlist_view_t *                        pList,
+  qmodel_range_t                        range
+) {
+  if (range.firstColumn) {
+    return 0;
+  }
+  qlist_view_forget_range(
+    pList,
+    range.firstRow,
+    range.rowCount > UINT64_MAX - range.firstRow ? UINT64_MAX : range.firstRow + range.rowCount
+  );
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT_VOID(
+  qlist_view_model_reset,
+  qlist_view_t *                        pList
+) {
+  qlist_view_reset(pList);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qlist_view_key_press,
+  qlist_view_t *                        pList,
+  qkey_event_t *                        pEvent
+) {
+  int64_t page;
+
+  page = QMAX(QP(pList)->pool.count, 1);
+  switch (pEvent->code) {
+    case QKEY_UP:
+      pEvent->accepted = QTRUE;
+      return qlist_view_scroll_by(pList, -1);
+    case QKEY_DOWN:
+      pEvent->accepted = QTRUE;
+      return qlist_view_scroll_by(pList, 1);
+    case QKEY_PAGE_UP:
+      pEvent->accepted = QTRUE;
+      return qlist_view_scroll_by(pList, -page);
+    case QKEY_PAGE_DOWN:
+      pEvent->accepted = QTRUE;
+      return qlist_view_scroll_by(pList, page);
+    case QKEY_HOME:
+      pEvent->accepted = QTRUE;
+      return qlist_view_set_scroll(pList, 0);
+    case QKEY_END:
+      pEvent->accepted = QTRUE;
+      return qlist_view_set_scroll(pList, UINT64_MAX);
+    default:
+      return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// List View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_list_view (
+  qalloc_t const *                      pAllocator,
+  qlist_view_t **                       pList
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qlist_view_t * list;
+
+  // Configure the list view as a widget.
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qlist_view_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qlist_view_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_list_view);
+  widgetConfig.pfnRecalculate = QRECALC_PTR(qlist_view_recalculate);
+  widgetConfig.pfnPaint       = QPAINTER_PTR(qlist_view_paint);
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = NULL;
+
+  // Allocate the list view.
+  err = qcreate_widget(
+    &widgetConfig,
+    &list
+  );
+  if (err) {
+    return err;
+  }
+
+  // A list has no natural size (its content can be any length), so it takes what it can.
+  QW(list)->sizePolicy = QPOLICY_EXPANDING;
+  qwidget_set_focusable(list, QTRUE);
+  err = qwidget_connect(QW(list), on_key_press, list, qlist_view_key_press);
+  if (err) {
+    qdestroy_list_view(list);
+    return err;
+  }
+
+  // Return the list view to the caller.
+  *pList = list;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_list_view (
+  qlist_view_t *                        pList
+) {
+  qalloc_t const * pAllocator;
+  pAllocator = QW(pList)->pAllocator;
+  if (QP(pList)->pModel) {
+    qwidget_disconnect(QP(pList)->pModel, pList);
+  }
+  (void)qlist_view_resize_pool(pList, 0);
+  qarray_deinit(pAllocator, &QP(pList)->pool);
+  qfree(pAllocator, pList);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_source (
+  qlist_view_t *                        pList,
+  qlist_source_t const *                pSource
+) {
+  if (pSource && !pSource->pfnRender) {
+    return EINVAL;
+  }
+  if (QP(pList)->pModel) {
+    qwidget_disconnect(QP(pList)->pModel, pList);
+    QP(pList)->pModel = NULL;
+  }
+  if (pSource) {
+    QP(pList)->source = *pSource;
+  }
+  else {
+    memset(&QP(pList)->source, 0, sizeof(qlist_source_t));
+  }
+  qlist_view_reset(pList);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_model (
+  qlist_view_t *                        pList,
+  qmodel_t *                            pModel
+) {
+  int err;
+  qlist_source_t source;
+
+  // Detach the previous model first, which also covers setting the same model again.
+  (void)qlist_view_set_source(pList, NULL);
+  if (!pModel) {
+    return 0;
+  }
+
+  if (
+    (err = qwidget_connect(pModel, rows_inserted, pList, qlist_view_rows_inserted)) ||
+    (err = qwidget_connect(pModel, rows_removed, pList, qlist_view_rows_removed)) ||
+    (err = qwidget_connect(pModel, data_changed, pList, qlist_view_data_changed)) ||
+    (err = qwidget_connect(pModel, reset, pList, qlist_view_model_reset))
+  ) {
+    qwidget_disconnect(pModel, pList);
+    return err;
+  }
+
+  // The model is read through a source, so that rendering doesn't care where rows come from.
+  source.pUserData   = pList;
+  source.pfnRowCount = (qlist_count_pfn)&qlist_view_model_rows;
+  source.pfnRender   = (qlist_render_pfn)&qlist_view_model_render;
+  QP(pList)->source = source;
+  QP(pList)->pModel = pModel;
+  qlist_view_reset(pList);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qlist_view_reset (
+  qlist_view_t *                        pList
+) {
+  QP(pList)->rowCount = 0;
+  if (QP(pList)->source.pfnRowCount) {
+    QP(pList)->rowCount = QP(pList)->source.pfnRowCount(QP(pList)->source.pUserData);
+  }
+  QP(pList)->scrollOffset = QMIN(QP(pList)->scrollOffset, qlist_view_max_scroll(pList));
+  qlist_view_forget_rows(pList);
+  qwidget_mark_dirty(pList);
+}
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qlist_view_get_scroll (
+  qlist_view_t const *                  pList
+) {
+  return QP(pList)->scrollOffset;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_scroll (
+  qlist_view_t *                        pList,
+  uint64_t                              offset
+) {
+  uint64_t delta;
+  uint32_t poolCount;
+
+  offset = QMIN(offset, qlist_view_max_scroll(pList));
+  if (offset == QP(pList)->scrollOffset) {
+    return 0;
+  }
+
+  // Rotate the ring by the distance, so renderers stay with the rows they hold.
+  // Past one page nothing can be reused, and every renderer misses anyway.
+  poolCount = QP(pList)->pool.count;
+  if (poolCount) {
+    if (offset > QP(pList)->scrollOffset) {
+      delta = (offset - QP(pList)->scrollOffset) % poolCount;
+      QP(pList)->poolHead = (uint32_t)((QP(pList)->poolHead + delta) % poolCount);
+    }
+    else {
+      delta = (QP(pList)->scrollOffset - offset) % poolCount;
+      QP(pList)->poolHead = (uint32_t)((QP(pList)->poolHead + poolCount - delta) % poolCount);
+    }
+  }
+
+  QP(pList)->scrollOffset = offset;
+  qwidget_mark_dirty(pList);
+  return qwidget_emit(pList, scrolled, offset);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_scroll_by (
+  qlist_view_t *                        pList,
+  int64_t                               delta
+) {
+  uint64_t offset;
+  if (delta < 0) {
+    offset = (uint64_t)-(delta + 1) + 1;
+    offset = offset > QP(pList)->scrollOffset ? 0 : QP(pList)->scrollOffset - offset;
+  }
+  else {
+    offset = QP(pList)->scrollOffset + (uint64_t)delta;
+    offset = offset < QP(pList)->scrollOffset ? UINT64_MAX : offset;
+  }
+  return qlist_view_set_scroll(pList, offset);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_row_set_text (
+  qlist_row_t *                         pRow,
+  char const *                          text,
+  size_t                                n
+) {
+  int err;
+
+  if (n > UINT32_MAX) {
+    return ERANGE;
+  }
+  if (pRow->text.capacity < n) {
+    err = qarray_resize(pRow->pAllocator, &pRow->text, (uint32_t)n);
+    if (err) {
+      return err;
+    }
+  }
+  memcpy(pRow->text.pData, text, n);
+  pRow->text.count = (uint32_t)n;
+  return 0;
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
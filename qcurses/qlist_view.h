@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QLIST_VIEW_H
+#define   QLIST_VIEW_H
+
+#include "qcurses.h"
+#include "qmodel.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// List View Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qlist_row_t);
+QDECLARE_STRUCT(qlist_source_t);
+
+typedef uint64_t (QCURSESPTR *qlist_count_pfn)(void *);
+typedef int (QCURSESPTR *qlist_render_pfn)(void *, uint64_t, qlist_row_t *);
+
+////////////////////////////////////////////////////////////////////////////////
+// List View Definition
+////////////////////////////////////////////////////////////////////////////////
+
+// The list only asks the source about rows as they scroll into view.
+// Note: pfnRender must fill the row with qlist_row_set_text(), which copies the text.
+//------------------------------------------------------------------------------
+struct qlist_source_t {
+  void *                                pUserData;
+  qlist_count_pfn                       pfnRowCount;
+  qlist_render_pfn                      pfnRender;
+};
+
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qlist_view_t)
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(scrolled, uint64_t offset);
+  QWIDGET_SIGNALS_END
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// List View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_list_view (
+  qalloc_t const *                      pAllocator,
+  qlist_view_t **                       pList
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_list_view (
+  qlist_view_t *                        pList
+);
+
+// Replaces the source, and forgets every row that was rendered from the old one.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_source (
+  qlist_view_t *                        pList,
+  qlist_source_t const *                pSource
+);
+
+// Shows the first column of the model, and follows its changes (only affected rows are painted).
+// Note: This replaces any source, and setting a source (or NULL) detaches the model.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_model (
+  qlist_view_t *                        pList,
+  qmodel_t *                            pModel
+);
+
+// Call this when the source changed, the row count is read again and all rows re-rendered.
+//------------------------------------------------------------------------------
+void QCURSESCALL qlist_view_reset (
+  qlist_view_t *                        pList
+);
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qlist_view_get_scroll (
+  qlist_view_t const *                  pList
+);
+
+// Makes the row the first visible row (limited so that the last page stays full).
+// Note: Rows which remain visible are not rendered again, only the newly exposed ones.
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_set_scroll (
+  qlist_view_t *                        pList,
+  uint64_t                              offset
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_view_scroll_by (
+  qlist_view_t *                        pList,
+  int64_t                               delta
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qlist_row_set_text (
+  qlist_row_t *                         pRow,
+  char const *                          text,
+  size_t                                n
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QLIST_VIEW_H
@@ -23,20 +23,30 @@
 extern "C" {
 #endif // __cplusplus
 
+////////////////////////////////////////////////////////////////////////////////
+// Math Types
+////////////////////////////////////////////////////////////////////////////////
+
+// Offsets are signed so that scrolled content is allowed to begin before a viewport.
+// Extents are unsigned, and are wide enough for virtual content larger than a screen.
+// Together, a qregion_t is four 32-bit lanes (16 bytes) which fits a single SIMD register.
+typedef int32_t                         qoffset_t;
+typedef uint32_t                        qextent_t;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Math Structures
 ////////////////////////////////////////////////////////////////////////////////
 
 //------------------------------------------------------------------------------
 struct qcoord_t {
-  size_t                                row;
-  size_t                                column;
+  qoffset_t                             row;
+  qoffset_t                             column;
 };
 
 //------------------------------------------------------------------------------
 struct qbounds_t {
-  size_t                                rows;
-  size_t                                columns;
+  qextent_t                             rows;
+  qextent_t                             columns;
 };
 
 //------------------------------------------------------------------------------
@@ -51,8 +61,8 @@ struct qregion_t {
 
 //------------------------------------------------------------------------------
 static inline qcoord_t QCURSESCALL qcoord (
-  size_t                                x,
-  size_t                                y
+  qoffset_t                             x,
+  qoffset_t                             y
 ) {
   qcoord_t coord;
   coord.row     = y;
@@ -70,8 +80,8 @@ static inline int QCURSESCALL qcoord_equal (
 
 //------------------------------------------------------------------------------
 static inline qbounds_t QCURSESCALL qbounds (
-  size_t                                rows,
-  size_t                                columns
+  qextent_t                             rows,
+  qextent_t                             columns
 ) {
   qbounds_t bounds;
   bounds.rows     = rows;
@@ -89,21 +99,23 @@ static inline int QCURSESCALL qbounds_equal (
 
 //------------------------------------------------------------------------------
 static inline int QCURSESCALL qbounds_contains (
-  qbounds_t const *              pBounds,
-  qcoord_t const *               pCoord
+  qbounds_t const *                     pBounds,
+  qcoord_t const *                      pCoord
 ) {
   return (
-    pBounds->rows     > pCoord->row     &&
-    pBounds->columns  > pCoord->column
+    pCoord->row       >= 0                            &&
+    pCoord->column    >= 0                            &&
+    pBounds->rows     >  (qextent_t)pCoord->row       &&
+    pBounds->columns  >  (qextent_t)pCoord->column
   );
 }
 
 //------------------------------------------------------------------------------
 static inline qregion_t QCURSESCALL qregion (
-  size_t                                x,
-  size_t                                y,
-  size_t                                rows,
-  size_t                                columns
+  qoffset_t                             x,
+  qoffset_t                             y,
+  qextent_t                             rows,
+  qextent_t                             columns
 ) {
   qregion_t region;
   region.coord  = qcoord(x, y);
@@ -121,6 +133,88 @@ static inline int QCURSESCALL qregion_equal (
     qbounds_equal(&pLhs->bounds, &pRhs->bounds);
 }
 
+// Note: The region helpers below are branch-free over the four lanes of a region.
+//       Edges are computed in 64-bit so that an offset plus an extent never overflows.
+//------------------------------------------------------------------------------
+static inline int QCURSESCALL qregion_empty (
+  qregion_t const *                     pRegion
+) {
+  return (pRegion->bounds.rows == 0) | (pRegion->bounds.columns == 0);
+}
+
+//------------------------------------------------------------------------------
+static inline int QCURSESCALL qregion_contains (
+  qregion_t const *                     pRegion,
+  qcoord_t const *                      pCoord
+) {
+  int64_t const row    = (int64_t)pCoord->row    - pRegion->coord.row;
+  int64_t const column = (int64_t)pCoord->column - pRegion->coord.column;
+  return
+    (row    >= 0) & (row    < (int64_t)pRegion->bounds.rows) &
+    (column >= 0) & (column < (int64_t)pRegion->bounds.columns);
+}
+
+//------------------------------------------------------------------------------
+static inline int QCURSESCALL qregion_contains_region (
+  qregion_t const *                     pOuter,
+  qregion_t const *                     pInner
+) {
+  return
+    (pInner->coord.row    >= pOuter->coord.row)                           &
+    (pInner->coord.column >= pOuter->coord.column)                        &
+    ((int64_t)pInner->coord.row + pInner->bounds.rows <=
+     (int64_t)pOuter->coord.row + pOuter->bounds.rows)                    &
+    ((int64_t)pInner->coord.column + pInner->bounds.columns <=
+     (int64_t)pOuter->coord.column + pOuter->bounds.columns);
+}
+
+// Returns the overlap of both regions, which is empty (zero bounds) if they don't overlap.
+//------------------------------------------------------------------------------
+static inline qregion_t QCURSESCALL qregion_intersect (
+  qregion_t const *                     pLhs,
+  qregion_t const *                     pRhs
+) {
+  qregion_t region;
+  int64_t const top    = QMAX(pLhs->coord.row,    pRhs->coord.row);
+  int64_t const left   = QMAX(pLhs->coord.column, pRhs->coord.column);
+  int64_t const bottom = QMIN((int64_t)pLhs->coord.row    + pLhs->bounds.rows,
+                              (int64_t)pRhs->coord.row    + pRhs->bounds.rows);
+  int64_t const right  = QMIN((int64_t)pLhs->coord.column + pLhs->bounds.columns,
+                              (int64_t)pRhs->coord.column + pRhs->bounds.columns);
+  region.coord.row      = (qoffset_t)top;
+  region.coord.column   = (qoffset_t)left;
+  region.bounds.rows    = (qextent_t)QMAX(bottom - top, 0);
+  region.bounds.columns = (qextent_t)QMAX(right - left, 0);
+  return region;
+}
+
+// Returns the smallest region which covers both regions (empty regions are ignored).
+//------------------------------------------------------------------------------
+static inline qregion_t QCURSESCALL qregion_union (
+  qregion_t const *                     pLhs,
+  qregion_t const *                     pRhs
+) {
+  qregion_t region;
+  int64_t top, left, bottom, right;
+  if (qregion_empty(pLhs)) {
+    return *pRhs;
+  }
+  if (qregion_empty(pRhs)) {
+    return *pLhs;
+  }
+  top    = QMIN(pLhs->coord.row,    pRhs->coord.row);
+  left   = QMIN(pLhs->coord.column, pRhs->coord.column);
+  bottom = QMAX((int64_t)pLhs->coord.row    + pLhs->bounds.rows,
+                (int64_t)pRhs->coord.row    + pRhs->bounds.rows);
+  right  = QMAX((int64_t)pLhs->coord.column + pLhs->bounds.columns,
+                (int64_t)pRhs->coord.column + pRhs->bounds.columns);
+  region.coord.row      = (qoffset_t)top;
+  region.coord.column   = (qoffset_t)left;
+  region.bounds.rows    = (qextent_t)QMIN(bottom - top, (int64_t)QINFINITE);
+  region.bounds.columns = (qextent_t)QMIN(right - left, (int64_t)QINFINITE);
+  return region;
+}
+
 #ifdef    __cplusplus
 }
 #endif // __cplusplus
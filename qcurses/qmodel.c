@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qmodel.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Model Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qmodel_t) {
+  qmodel_interface_t                    interface;
+};
+
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(rows_inserted, uint64_t, uint64_t);
+QDEFINE_EMITTER(rows_removed, uint64_t, uint64_t);
+QDEFINE_EMITTER(data_changed, qmodel_range_t);
+QDEFINE_EMITTER_VOID(reset);
+
+////////////////////////////////////////////////////////////////////////////////
+// Model Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_model (
+  qalloc_t const *                      pAllocator,
+  qmodel_interface_t const *            pInterface,
+  qmodel_t **                           pModel
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qmodel_t * model;
+
+  if (!pInterface->pfnRowCount || !pInterface->pfnData) {
+    return EINVAL;
+  }
+
+  // Configure the model as a widget (only for its signals, it is never painted).
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qmodel_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qmodel_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_model);
+  widgetConfig.pfnRecalculate = NULL;
+  widgetConfig.pfnPaint       = NULL;
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = NULL;
+
+  // Allocate the model.
+  err = qcreate_widget(
+    &widgetConfig,
+    &model
+  );
+  if (err) {
+    return err;
+  }
+  QP(model)->interface = *pInterface;
+
+  // Return the model to the caller.
+  *pModel = model;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_model (
+  qmodel_t *                            pModel
+) {
+  qfree(QW(pModel)->pAllocator, pModel);
+}
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qmodel_row_count (
+  qmodel_t *                            pModel
+) {
+  return QP(pModel)->interface.pfnRowCount(QP(pModel)->interface.pUserData);
+}
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qmodel_column_count (
+  qmodel_t *                            pModel
+) {
+  if (!QP(pModel)->interface.pfnColumnCount) {
+    return 1;
+  }
+  return QP(pModel)->interface.pfnColumnCount(QP(pModel)->interface.pUserData);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_data (
+  qmodel_t *                            pModel,
+  uint64_t                              row,
+  uint32_t                              column,
+  char const **                         pText,
+  size_t *                              pLength
+) {
+  return QP(pModel)->interface.pfnData(
+    QP(pModel)->interface.pUserData,
+    row,
+    column,
+    pText,
+    pLength
+  );
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_rows_inserted (
+  qmodel_t *                            pModel,
+  uint64_t                              first,
+  uint64_t                              count
+) {
+  if (!count) {
+    return 0;
+  }
+  return qwidget_emit(pModel, rows_inserted, first, count);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_rows_removed (
+  qmodel_t *                            pModel,
+  uint64_t                              first,
+  uint64_t                              count
+) {
+  if (!count) {
+    return 0;
+  }
+  return qwidget_emit(pModel, rows_removed, first, count);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_data_changed (
+  qmodel_t *                            pModel,
+  qmodel_range_t const *                pRange
+) {
+  if (!pRange->rowCount || !pRange->columnCount) {
+    return 0;
+  }
+  return qwidget_emit(pModel, data_changed, *pRange);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_reset (
+  qmodel_t *                            pModel
+) {
+  return qwidget_emit_void(pModel, reset);
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
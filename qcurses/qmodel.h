@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QMODEL_H
+#define   QMODEL_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Model Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qmodel_interface_t);
+QDECLARE_STRUCT(qmodel_range_t);
+
+typedef uint64_t (QCURSESPTR *qmodel_rows_pfn)(void *);
+typedef uint32_t (QCURSESPTR *qmodel_columns_pfn)(void *);
+typedef int (QCURSESPTR *qmodel_data_pfn)(void *, uint64_t, uint32_t, char const **, size_t *);
+
+////////////////////////////////////////////////////////////////////////////////
+// Model Definition
+////////////////////////////////////////////////////////////////////////////////
+
+// The model reads the data through these, pfnColumnCount may be NULL for a single column.
+// Note: Text returned by pfnData only needs to stay valid until the next call into the model.
+//------------------------------------------------------------------------------
+struct qmodel_interface_t {
+  void *                                pUserData;
+  qmodel_rows_pfn                       pfnRowCount;
+  qmodel_columns_pfn                    pfnColumnCount;
+  qmodel_data_pfn                       pfnData;
+};
+
+//------------------------------------------------------------------------------
+struct qmodel_range_t {
+  uint64_t                              firstRow;
+  uint64_t                              rowCount;
+  uint32_t                              firstColumn;
+  uint32_t                              columnCount;
+};
+
+// Views connect to these signals, and only update the rows that they cover.
+// Note: The model is never placed within the widget tree, it is only a signal source.
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qmodel_t)
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(rows_inserted, uint64_t first, uint64_t count);
+    QSIGNAL(rows_removed, uint64_t first, uint64_t count);
+    QSIGNAL(data_changed, qmodel_range_t range);
+    QSIGNAL_VOID(reset);
+  QWIDGET_SIGNALS_END
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// Model Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_model (
+  qalloc_t const *                      pAllocator,
+  qmodel_interface_t const *            pInterface,
+  qmodel_t **                           pModel
+);
+
+// Note: Views must be given a different model (or none) before their model is destroyed.
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_model (
+  qmodel_t *                            pModel
+);
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qmodel_row_count (
+  qmodel_t *                            pModel
+);
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qmodel_column_count (
+  qmodel_t *                            pModel
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_data (
+  qmodel_t *                            pModel,
+  uint64_t                              row,
+  uint32_t                              column,
+  char const **                         pText,
+  size_t *                              pLength
+);
+
+// The notify functions are called by the owner of the data, after it has changed.
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_rows_inserted (
+  qmodel_t *                            pModel,
+  uint64_t                              first,
+  uint64_t                              count
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_rows_removed (
+  qmodel_t *                            pModel,
+  uint64_t                              first,
+  uint64_t                              count
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_data_changed (
+  qmodel_t *                            pModel,
+  qmodel_range_t const *                pRange
+);
+
+// Use this when the changes are too broad to describe, every view starts over.
+//------------------------------------------------------------------------------
+int QCURSESCALL qmodel_notify_reset (
+  qmodel_t *                            pModel
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QMODEL_H
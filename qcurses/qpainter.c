@@ -23,13 +23,26 @@
 // Painter Functions
 ////////////////////////////////////////////////////////////////////////////////
 
+// Moves the region into screen coordinates, and cuts it down to the clip.
+//------------------------------------------------------------------------------
+static qregion_t qpainter_map_region (
+  qpainter_t const *                    pPainter,
+  qregion_t const *                     pRegion
+) {
+  qregion_t region;
+  region = *pRegion;
+  region.coord.row    += pPainter->origin.row;
+  region.coord.column += pPainter->origin.column;
+  return qregion_intersect(&region, &pPainter->clip);
+}
+
 //------------------------------------------------------------------------------
 static int qpainter_clearins (
   qpainter_t *                          pPainter,
   qregion_t const *                     pRegion
 ) {
   int err;
-  size_t currRow;
+  qextent_t currRow;
 
   for (currRow = 0; currRow < pRegion->bounds.rows; ++currRow) {
     err = mvwinsnstr(
@@ -53,7 +66,7 @@ static int qpainter_clearadd (
   qregion_t const *                     pRegion
 ) {
   int err;
-  size_t currRow;
+  qextent_t currRow;
 
   for (currRow = 0; currRow < pRegion->bounds.rows; ++currRow) {
     err = mvwaddnstr(
@@ -72,14 +85,14 @@ static int qpainter_clearadd (
 }
 
 //------------------------------------------------------------------------------
-int QCURSESCALL qpainter_clear (
+static int qpainter_clear_screen (
   qpainter_t *                          pPainter,
   qregion_t const *                     pRegion
 ) {
 
   // Select between clearins and clearadd (clear mechanism).
   // This is because NCurses can report failure if we scroll the screen with scroll-lock.
-  if (pPainter->boundary.columns == pRegion->coord.column + pRegion->bounds.columns) {
+  if ((int64_t)pPainter->boundary.columns == (int64_t)pRegion->coord.column + pRegion->bounds.columns) {
     return qpainter_clearins(pPainter, pRegion);
   }
   else {
@@ -87,6 +100,47 @@ int QCURSESCALL qpainter_clear (
   }
 }
 
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_set_style (
+  qpainter_t *                          pPainter,
+  qstyle_t                              style
+) {
+  attr_t attributes;
+
+  attributes = A_NORMAL;
+  if (style & QSTYLE_BOLD_BIT) {
+    attributes |= A_BOLD;
+  }
+  if (style & QSTYLE_DIM_BIT) {
+    attributes |= A_DIM;
+  }
+  if (style & QSTYLE_UNDERLINE_BIT) {
+    attributes |= A_UNDERLINE;
+  }
+  if (style & QSTYLE_REVERSE_BIT) {
+    attributes |= A_REVERSE;
+  }
+  if (style & QSTYLE_BLINK_BIT) {
+    attributes |= A_BLINK;
+  }
+  attributes |= COLOR_PAIR(style >> QSTYLE_COLOR_SHIFT);
+  wattrset(pPainter->pWindow, (int)attributes);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qpainter_clear (
+  qpainter_t *                          pPainter,
+  qregion_t const *                     pRegion
+) {
+  qregion_t region;
+
+  region = qpainter_map_region(pPainter, pRegion);
+  if (qregion_empty(&region)) {
+    return 0;
+  }
+  return qpainter_clear_screen(pPainter, &region);
+}
+
 //------------------------------------------------------------------------------
 static size_t QCURSESCALL qcountprintable (
   char const *                          pData,
@@ -96,6 +150,63 @@ static size_t QCURSESCALL qcountprintable (
   return n;
 }
 
+// Moves the text into screen coordinates, cutting off whatever falls outside of the clip.
+// Returns false if nothing of the text is left to paint.
+//------------------------------------------------------------------------------
+static qbool_t qpainter_map_text (
+  qpainter_t const *                    pPainter,
+  qcoord_t const *                      pOrigin,
+  qcoord_t *                            pCoord,
+  char const **                         ppData,
+  size_t *                              pN
+) {
+  int64_t row;
+  int64_t column;
+  int64_t right;
+  size_t skipped;
+
+  row    = (int64_t)pOrigin->row    + pPainter->origin.row;
+  column = (int64_t)pOrigin->column + pPainter->origin.column;
+  right  = (int64_t)pPainter->clip.coord.column + pPainter->clip.bounds.columns;
+  if (row < pPainter->clip.coord.row || row >= (int64_t)pPainter->clip.coord.row + pPainter->clip.bounds.rows) {
+    return QFALSE;
+  }
+
+  // Note: This relies on every character being one column wide (see qcountprintable).
+  if (column < pPainter->clip.coord.column) {
+    skipped = (size_t)(pPainter->clip.coord.column - column);
+    if (skipped >= *pN) {
+      return QFALSE;
+    }
+    *ppData += skipped;
+    *pN -= skipped;
+    column = pPainter->clip.coord.column;
+  }
+  if (column >= right) {
+    return QFALSE;
+  }
+  *pN = QMIN(*pN, (size_t)(right - column));
+
+  *pCoord = qcoord((qoffset_t)column, (qoffset_t)row);
+  return QBOOL(*pN);
+}
+
+//------------------------------------------------------------------------------
+static int qpainter_insstr_screen (
+  qpainter_t *                          pPainter,
+  qcoord_t const *                      pOrigin,
+  char const *                          pData,
+  size_t                                n
+);
+
+//------------------------------------------------------------------------------
+static int qpainter_addstr_screen (
+  qpainter_t *                          pPainter,
+  qcoord_t const *                      pOrigin,
+  char const *                          pData,
+  size_t                                n
+);
+
 //------------------------------------------------------------------------------
 int QCURSESCALL qpainter_paint (
   qpainter_t *                          pPainter,
@@ -104,6 +215,11 @@ int QCURSESCALL qpainter_paint (
   size_t                                n
 ) {
   size_t printableCharacters;
+  qcoord_t coord;
+
+  if (!qpainter_map_text(pPainter, pOrigin, &coord, &pData, &n)) {
+    return 0;
+  }
 
   // Calculate the number of printable characters (non-command).
   printableCharacters = qcountprintable(pData, n);
@@ -111,11 +227,11 @@ int QCURSESCALL qpainter_paint (
   // Either select to add or insert depending on how this affects the screen.
   // We can fail to addstr if it will update the cursor past the screen boundary.
   // As a mitigation, we instead select between add/insert depending on parameters.
-  if (pPainter->boundary.columns == pOrigin->column + printableCharacters) {
-    return qpainter_insstr(pPainter, pOrigin, pData, n);
+  if ((int64_t)pPainter->boundary.columns == (int64_t)coord.column + (int64_t)printableCharacters) {
+    return qpainter_insstr_screen(pPainter, &coord, pData, n);
   }
   else {
-    return qpainter_addstr(pPainter, pOrigin, pData, n);
+    return qpainter_addstr_screen(pPainter, &coord, pData, n);
   }
 }
 
@@ -128,10 +244,9 @@ static int qpainter_determine_failure (
 ) {
   n = qcountprintable(pData, n);
   if (
-    pPainter->boundary.columns  <= pOrigin->column      ||
-    pPainter->boundary.rows     <= pOrigin->row         ||
+    !qbounds_contains(&pPainter->boundary, pOrigin)     ||
     pPainter->boundary.columns  <  n                    ||
-    pPainter->boundary.columns  <  pOrigin->column + n
+    pPainter->boundary.columns  <  (size_t)pOrigin->column + n
   ) {
     return ERANGE;
   }
@@ -139,7 +254,7 @@ static int qpainter_determine_failure (
 }
 
 //------------------------------------------------------------------------------
-int QCURSESCALL qpainter_insstr (
+static int qpainter_insstr_screen (
   qpainter_t *                          pPainter,
   qcoord_t const *                      pOrigin,
   char const *                          pData,
@@ -169,7 +284,7 @@ int QCURSESCALL qpainter_insstr (
 }
 
 //------------------------------------------------------------------------------
-int QCURSESCALL qpainter_addstr (
+static int qpainter_addstr_screen (
   qpainter_t *                          pPainter,
   qcoord_t const *                      pOrigin,
   char const *                          pData,
@@ -197,3 +312,126 @@ int QCURSESCALL qpainter_addstr (
 
   return 0;
 }
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qpainter_insstr (
+  qpainter_t *                          pPainter,
+  qcoord_t const *                      pOrigin,
+  char const *                          pData,
+  size_t                                n
+) {
+  qcoord_t coord;
+  if (!qpainter_map_text(pPainter, pOrigin, &coord, &pData, &n)) {
+    return 0;
+  }
+  return qpainter_insstr_screen(pPainter, &coord, pData, n);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qpainter_addstr (
+  qpainter_t *                          pPainter,
+  qcoord_t const *                      pOrigin,
+  char const *                          pData,
+  size_t                                n
+) {
+  qcoord_t coord;
+  if (!qpainter_map_text(pPainter, pOrigin, &coord, &pData, &n)) {
+    return 0;
+  }
+  return qpainter_addstr_screen(pPainter, &coord, pData, n);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_save (
+  qpainter_t const *                    pPainter,
+  qpainter_state_t *                    pState
+) {
+  pState->origin = pPainter->origin;
+  pState->clip = pPainter->clip;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_restore (
+  qpainter_t *                          pPainter,
+  qpainter_state_t const *              pState
+) {
+  pPainter->origin = pState->origin;
+  pPainter->clip = pState->clip;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_translate (
+  qpainter_t *                          pPainter,
+  qoffset_t                             columns,
+  qoffset_t                             rows
+) {
+  pPainter->origin.row    += rows;
+  pPainter->origin.column += columns;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_clip (
+  qpainter_t *                          pPainter,
+  qregion_t const *                     pRegion
+) {
+  pPainter->clip = qpainter_map_region(pPainter, pRegion);
+}
+
+//------------------------------------------------------------------------------
+qregion_t QCURSESCALL qpainter_get_clip (
+  qpainter_t const *                    pPainter
+) {
+  qregion_t region;
+  region = pPainter->clip;
+  region.coord.row    -= pPainter->origin.row;
+  region.coord.column -= pPainter->origin.column;
+  return region;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qpainter_scroll (
+  qpainter_t *                          pPainter,
+  qregion_t const *                     pRegion,
+  qoffset_t                             rows
+) {
+  int err;
+  bool wasScrolling;
+  qregion_t region;
+  qregion_t mapped;
+
+  region = qpainter_map_region(pPainter, pRegion);
+  if (qregion_empty(&region) || !rows) {
+    return 0;
+  }
+
+  // Content outside of the clip was never painted, so a clipped region can't be scrolled into view.
+  mapped = *pRegion;
+  mapped.coord.row    += pPainter->origin.row;
+  mapped.coord.column += pPainter->origin.column;
+  if (!qregion_equal(&region, &mapped)) {
+    return ENOTSUP;
+  }
+  if (region.coord.column != 0 || region.bounds.columns != pPainter->boundary.columns) {
+    return ENOTSUP;
+  }
+
+  // Scrolling by the whole region (or more) leaves nothing, so it is only a clear.
+  if ((uint32_t)QMAX(rows, -rows) >= region.bounds.rows) {
+    return qpainter_clear_screen(pPainter, &region);
+  }
+
+  // Note: The scrolling region has to be reset, otherwise later output would scroll within it.
+  wasScrolling = is_scrollok(pPainter->pWindow);
+  scrollok(pPainter->pWindow, TRUE);
+  err = wsetscrreg(
+    pPainter->pWindow,
+    (int)region.coord.row,
+    (int)(region.coord.row + region.bounds.rows - 1)
+  );
+  if (err != ERR) {
+    err = wscrl(pPainter->pWindow, (int)rows);
+  }
+  (void)wsetscrreg(pPainter->pWindow, 0, (int)pPainter->boundary.rows - 1);
+  scrollok(pPainter->pWindow, wasScrolling);
+  return (err == ERR) ? EFAULT : 0;
+}
@@ -17,15 +17,80 @@
 #define   QPAINTER_H
 
 #include "qcurses.h"
+#include "qmath.h"
 
 #ifdef    __cplusplus
 extern "C" {
 #endif // __cplusplus
 
+////////////////////////////////////////////////////////////////////////////////
+// Painter Definition
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qpainter_state_t);
+
+// The transform of a painter, held by the caller of qpainter_save().
+//------------------------------------------------------------------------------
+struct qpainter_state_t {
+  qcoord_t                              origin;
+  qregion_t                             clip;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Painter Functions
 ////////////////////////////////////////////////////////////////////////////////
 
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_save (
+  qpainter_t const *                    pPainter,
+  qpainter_state_t *                    pState
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_restore (
+  qpainter_t *                          pPainter,
+  qpainter_state_t const *              pState
+);
+
+// Moves the origin, every coordinate painted after this is offset by the given amount.
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_translate (
+  qpainter_t *                          pPainter,
+  qoffset_t                             columns,
+  qoffset_t                             rows
+);
+
+// Narrows the clip to the region (in translated coordinates), nothing outside is painted.
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_clip (
+  qpainter_t *                          pPainter,
+  qregion_t const *                     pRegion
+);
+
+// Returns the clip (in translated coordinates), e.g. to skip content which would not be painted.
+//------------------------------------------------------------------------------
+qregion_t QCURSESCALL qpainter_get_clip (
+  qpainter_t const *                    pPainter
+);
+
+// Moves the content of the region up (positive rows) or down, exposed rows are cleared.
+// Note: Terminals only scroll full-width regions, ENOTSUP means it has to be repainted instead.
+//       The same goes for a region which the clip cuts.
+//------------------------------------------------------------------------------
+int QCURSESCALL qpainter_scroll (
+  qpainter_t *                          pPainter,
+  qregion_t const *                     pRegion,
+  qoffset_t                             rows
+);
+
+// Text painted after this takes on the style, until it is set again.
+// Note: Clearing uses the style too, so set QSTYLE_NONE once the styled text is painted.
+//------------------------------------------------------------------------------
+void QCURSESCALL qpainter_set_style (
+  qpainter_t *                          pPainter,
+  qstyle_t                              style
+);
+
 //------------------------------------------------------------------------------
 int QCURSESCALL qpainter_clear (
   qpainter_t *                          pPainter,
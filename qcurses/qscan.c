@@ -0,0 +1,176 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "qscan.h"
+#include <string.h>
+
+// Newlines are found a vector at a time where possible, AVX2 is only used if the CPU reports it.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define  QSCAN_HAS_AVX2
+# include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+# define  QSCAN_HAS_SSE2
+# include <emmintrin.h>
+#endif
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Scan Helpers
+////////////////////////////////////////////////////////////////////////////////
+
+// Records the line ending at the newline at offset, returns non-zero once pOffsets is full.
+//------------------------------------------------------------------------------
+static inline int qscan_emit (
+  qscan_t *                             pScan,
+  size_t                                offset,
+  size_t *                              pOffsets,
+  size_t *                              pCount,
+  size_t                                capacity
+) {
+  size_t const lineLength = offset - pScan->lineStart;
+  pOffsets[(*pCount)++] = offset + 1;
+  if (lineLength > pScan->maxLineLength) {
+    pScan->maxLineLength = lineLength;
+    pScan->maxLineCount = 1;
+  }
+  else if (lineLength == pScan->maxLineLength) {
+    ++pScan->maxLineCount;
+  }
+  pScan->lineStart = offset + 1;
+  pScan->offset = offset + 1;
+  return *pCount == capacity;
+}
+
+//------------------------------------------------------------------------------
+static size_t qscan_lines_fallback (
+  qscan_t *                             pScan,
+  char const *                          pData,
+  size_t                                n,
+  size_t *                              pOffsets,
+  size_t                                capacity
+) {
+  size_t count;
+  char const * pNewline;
+
+  // The C library memchr is usually vectorized as well.
+  count = 0;
+  while ((pNewline = memchr(pData + pScan->offset, '\n', n - pScan->offset))) {
+    if (qscan_emit(pScan, (size_t)(pNewline - pData), pOffsets, &count, capacity)) {
+      return count;
+    }
+  }
+  pScan->offset = n;
+  return count;
+}
+
+#ifdef    QSCAN_HAS_SSE2
+//------------------------------------------------------------------------------
+static size_t qscan_lines_sse2 (
+  qscan_t *                             pScan,
+  char const *                          pData,
+  size_t                                n,
+  size_t *                              pOffsets,
+  size_t                                capacity
+) {
+  size_t count;
+  size_t block;
+  uint32_t mask;
+  __m128i const newline = _mm_set1_epi8('\n');
+
+  // Each set bit of the mask is a newline within the block.
+  // Note: Stopping within a block is fine, the next call starts at the unaligned offset.
+  count = 0;
+  for (block = pScan->offset; block + 16 <= n; block += 16) {
+    mask = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const *)(pData + block)), newline)
+    );
+    for (; mask; mask &= mask - 1) {
+      if (qscan_emit(pScan, block + (size_t)__builtin_ctz(mask), pOffsets, &count, capacity)) {
+        return count;
+      }
+    }
+  }
+
+  pScan->offset = block;
+  return count + qscan_lines_fallback(pScan, pData, n, pOffsets + count, capacity - count);
+}
+#endif // QSCAN_HAS_SSE2
+
+#ifdef    QSCAN_HAS_AVX2
+//------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static size_t qscan_lines_avx2 (
+  qscan_t *                             pScan,
+  char const *                          pData,
+  size_t                                n,
+  size_t *                              pOffsets,
+  size_t                                capacity
+) {
+  size_t count;
+  size_t block;
+  uint32_t mask;
+  __m256i const newline = _mm256_set1_epi8('\n');
+
+  count = 0;
+  for (block = pScan->offset; block + 32 <= n; block += 32) {
+    mask = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const *)(pData + block)), newline)
+    );
+    for (; mask; mask &= mask - 1) {
+      if (qscan_emit(pScan, block + (size_t)__builtin_ctz(mask), pOffsets, &count, capacity)) {
+        return count;
+      }
+    }
+  }
+
+  pScan->offset = block;
+  return count + qscan_lines_fallback(pScan, pData, n, pOffsets + count, capacity - count);
+}
+#endif // QSCAN_HAS_AVX2
+
+////////////////////////////////////////////////////////////////////////////////
+// Scan Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+size_t QCURSESCALL qscan_lines (
+  qscan_t *                             pScan,
+  char const *                          pData,
+  size_t                                n,
+  size_t *                              pOffsets,
+  size_t                                capacity
+) {
+  if (capacity == 0 || pScan->offset >= n) {
+    return 0;
+  }
+#ifdef    QSCAN_HAS_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    return qscan_lines_avx2(pScan, pData, n, pOffsets, capacity);
+  }
+#endif // QSCAN_HAS_AVX2
+#ifdef    QSCAN_HAS_SSE2
+  return qscan_lines_sse2(pScan, pData, n, pOffsets, capacity);
+#else
+  return qscan_lines_fallback(pScan, pData, n, pOffsets, capacity);
+#endif // QSCAN_HAS_SSE2
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
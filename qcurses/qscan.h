@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QSCAN_H
+#define   QSCAN_H
+
+#include "qcurses.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Scan Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qscan_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Scan Structures
+////////////////////////////////////////////////////////////////////////////////
+
+// The state of splitting a buffer into lines, which may take several calls.
+// Note: All offsets are relative to the start of the buffer being scanned.
+//------------------------------------------------------------------------------
+struct qscan_t {
+  size_t                                offset;         // Where the next call continues scanning.
+  size_t                                lineStart;      // Where the current (unterminated) line starts.
+  size_t                                maxLineLength;  // The longest line written so far.
+  size_t                                maxLineCount;   // How many lines written were maxLineLength long.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Scan Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+static inline void qscan_init (
+  qscan_t *                             pScan,
+  size_t                                offset
+) {
+  pScan->offset = offset;
+  pScan->lineStart = offset;
+  pScan->maxLineLength = 0;
+  pScan->maxLineCount = 0;
+}
+
+// Writes the end of every newline-terminated line in pData[offset, n) to pOffsets.
+// The end is the offset just past the newline, which is also where the next line starts.
+// Returns how many were written, scanning stops early once capacity offsets are written.
+// Note: Scanning is complete once offset == n, the rest from lineStart has no newline yet.
+//------------------------------------------------------------------------------
+size_t QCURSESCALL qscan_lines (
+  qscan_t *                             pScan,
+  char const *                          pData,
+  size_t                                n,
+  size_t *                              pOffsets,
+  size_t                                capacity
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QSCAN_H
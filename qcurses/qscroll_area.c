@@ -0,0 +1,399 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qscroll_area.h"
+#include "qpainter.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Scroll Area Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// The widget is placed at the area's coordinate with its full bounds, scrolling only
+// changes the painter's translation, so the widget is never laid out again for it.
+// Note: The offset is the widget's public scrollOffset, so the spatial index can follow it.
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qscroll_area_t) {
+  qwidget_t *                           pWidget;
+  qregion_t                             widgetRegion;
+  qregion_t                             placedRegion;
+  qbool_t                               placedStale;
+  qcoord_t                              paintedOffset;  // What the screen currently shows.
+  qbool_t                               repaintAll;
+};
+
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(scrolled, qcoord_t);
+
+//------------------------------------------------------------------------------
+static inline qcoord_t qscroll_area_max_scroll (
+  qscroll_area_t const *                pArea
+) {
+  return qcoord(
+    (qoffset_t)(QP(pArea)->widgetRegion.bounds.columns - QMIN(QP(pArea)->widgetRegion.bounds.columns, QW(pArea)->outerRegion.bounds.columns)),
+    (qoffset_t)(QP(pArea)->widgetRegion.bounds.rows - QMIN(QP(pArea)->widgetRegion.bounds.rows, QW(pArea)->outerRegion.bounds.rows))
+  );
+}
+
+//------------------------------------------------------------------------------
+static inline qcoord_t qscroll_area_clamp (
+  qscroll_area_t const *                pArea,
+  int64_t                               column,
+  int64_t                               row
+) {
+  qcoord_t maxScroll;
+  maxScroll = qscroll_area_max_scroll(pArea);
+  return qcoord(
+    (qoffset_t)QMAX(QMIN(column, (int64_t)maxScroll.column), 0),
+    (qoffset_t)QMAX(QMIN(row, (int64_t)maxScroll.row), 0)
+  );
+}
+
+//------------------------------------------------------------------------------
+QRECALC(
+  qscroll_area_recalculate,
+  qscroll_area_t *                      pArea,
+  qregion_t const *                     pRegion
+) {
+  int err;
+  qbounds_t hint;
+  qregion_t widgetRegion;
+  qbool_t moved;
+
+  QW(pArea)->outerRegion = *pRegion;
+  QW(pArea)->innerRegion = *pRegion;
+
+  // Our parent has usually measured us already, otherwise this notices hint changes below.
+  err = qwidget_size_hint(pArea, &hint);
+  if (err) {
+    return err;
+  }
+
+  // Scrolling alone never gets here with anything stale, so the widget keeps its region.
+  if (!QP(pArea)->placedStale && qregion_equal(&QP(pArea)->placedRegion, pRegion)) {
+    if (QP(pArea)->pWidget && qwidget_is_dirty(QP(pArea)->pWidget)) {
+      return qwidget_recalculate(QP(pArea)->pWidget, &QP(pArea)->widgetRegion);
+    }
+    return 0;
+  }
+
+  // The widget gets its preferred bounds, but never less than what is visible.
+  widgetRegion = QP(pArea)->widgetRegion;
+  QP(pArea)->widgetRegion = *pRegion;
+  if (QP(pArea)->pWidget) {
+    err = qwidget_size_hint(QP(pArea)->pWidget, &hint);
+    if (err) {
+      return err;
+    }
+    QP(pArea)->widgetRegion.bounds = qbounds(
+      QMAX(hint.rows, pRegion->bounds.rows),
+      QMAX(hint.columns, pRegion->bounds.columns)
+    );
+    err = qwidget_recalculate(QP(pArea)->pWidget, &QP(pArea)->widgetRegion);
+    if (err) {
+      return err;
+    }
+  }
+  QW(pArea)->contentBounds = QP(pArea)->widgetRegion.bounds;
+  moved = QBOOL(!qregion_equal(&widgetRegion, &QP(pArea)->widgetRegion) || !qregion_equal(&QP(pArea)->placedRegion, pRegion));
+  QP(pArea)->placedRegion = *pRegion;
+  QP(pArea)->placedStale = QFALSE;
+  QW(pArea)->scrollOffset = qscroll_area_clamp(pArea, QW(pArea)->scrollOffset.column, QW(pArea)->scrollOffset.row);
+
+  // A hint which changed without moving anything leaves the screen as it is, the widget paints its own changes.
+  qwidget_mark_state(pArea, QSTATE_DIRTY_BIT);
+  if (moved) {
+    QP(pArea)->repaintAll = QTRUE;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QMEASURE(
+  qscroll_area_measure,
+  qscroll_area_t *                      pArea,
+  qbounds_t *                           pHint
+) {
+  int err;
+
+  *pHint = qbounds(0, 0);
+  if (QP(pArea)->pWidget) {
+    err = qwidget_size_hint(QP(pArea)->pWidget, pHint);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Only measured after a hint changed, so the widget has to be placed again.
+  QP(pArea)->placedStale = QTRUE;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QPAINTER(
+  qscroll_area_paint,
+  qscroll_area_t *                      pArea,
+  qpainter_t *                          pPainter
+) {
+  int err;
+  qoffset_t rows;
+  qregion_t exposed;
+  qpainter_state_t state;
+
+  if (!qwidget_is_dirty(pArea)) {
+    return 0;
+  }
+  if (qwidget_needs_repaint(pArea)) {
+    QP(pArea)->repaintAll = QTRUE;
+  }
+
+  // If only the offset changed vertically, the terminal can move what is already shown.
+  // Then only the rows which scrolled into view have to be painted.
+  exposed = QW(pArea)->outerRegion;
+  rows = QW(pArea)->scrollOffset.row - QP(pArea)->paintedOffset.row;
+  if (
+    !QP(pArea)->repaintAll &&
+    !(QP(pArea)->pWidget && qwidget_is_dirty(QP(pArea)->pWidget)) &&
+    QW(pArea)->scrollOffset.column == QP(pArea)->paintedOffset.column &&
+    rows != 0 && (qextent_t)QMAX(rows, -rows) < exposed.bounds.rows
+  ) {
+    err = qpainter_scroll(pPainter, &exposed, rows);
+    if (!err) {
+      if (rows > 0) {
+        exposed.coord.row += (qoffset_t)(exposed.bounds.rows - (qextent_t)rows);
+        exposed.bounds.rows = (qextent_t)rows;
+      }
+      else {
+        exposed.bounds.rows = (qextent_t)-rows;
+      }
+    }
+    else if (err != ENOTSUP) {
+      return err;
+    }
+  }
+
+  // If only the widget changed, everything shown is still in place and it can update itself.
+  // Otherwise, paint the widget through the exposed window, translated by the offset.
+  qpainter_save(pPainter, &state);
+  qpainter_clip(pPainter, &exposed);
+  if (!QP(pArea)->repaintAll && qcoord_equal(&QW(pArea)->scrollOffset, &QP(pArea)->paintedOffset)) {
+    err = 0;
+  }
+  else {
+    err = qpainter_clear(pPainter, &exposed);
+    if (!err && QP(pArea)->pWidget) {
+      qwidget_mark_repaint(QP(pArea)->pWidget);
+    }
+  }
+  if (!err && QP(pArea)->pWidget) {
+    qpainter_translate(pPainter, -QW(pArea)->scrollOffset.column, -QW(pArea)->scrollOffset.row);
+    err = qwidget_paint(QP(pArea)->pWidget, pPainter);
+  }
+  qpainter_restore(pPainter, &state);
+  if (err) {
+    return err;
+  }
+
+  QP(pArea)->paintedOffset = QW(pArea)->scrollOffset;
+  QP(pArea)->repaintAll = QFALSE;
+  qwidget_unmark_dirty(pArea);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QVISIT(
+  qscroll_area_visit,
+  qscroll_area_t *                      pArea,
+  qwidget_visitor_pfn                   pfnVisitor,
+  void *                                pUserData
+) {
+  if (QP(pArea)->pWidget) {
+    return pfnVisitor(QP(pArea)->pWidget, pUserData);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qscroll_area_key_press,
+  qscroll_area_t *                      pArea,
+  qkey_event_t *                        pEvent
+) {
+  qoffset_t page;
+  qcoord_t offset;
+
+  page = (qoffset_t)QMAX(QW(pArea)->outerRegion.bounds.rows, 1);
+  switch (pEvent->code) {
+    case QKEY_UP:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, 0, -1);
+    case QKEY_DOWN:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, 0, 1);
+    case QKEY_LEFT:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, -1, 0);
+    case QKEY_RIGHT:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, 1, 0);
+    case QKEY_PAGE_UP:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, 0, -page);
+    case QKEY_PAGE_DOWN:
+      pEvent->accepted = QTRUE;
+      return qscroll_area_scroll_by(pArea, 0, page);
+    case QKEY_HOME:
+      pEvent->accepted = QTRUE;
+      offset = qcoord(0, 0);
+      return qscroll_area_set_scroll(pArea, &offset);
+    case QKEY_END:
+      pEvent->accepted = QTRUE;
+      offset = qscroll_area_max_scroll(pArea);
+      offset.column = QW(pArea)->scrollOffset.column;
+      return qscroll_area_set_scroll(pArea, &offset);
+    default:
+      return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scroll Area Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_scroll_area (
+  qalloc_t const *                      pAllocator,
+  qscroll_area_t **                     pArea
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qscroll_area_t * area;
+
+  // Configure the scroll area as a widget.
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qscroll_area_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qscroll_area_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_scroll_area);
+  widgetConfig.pfnRecalculate = QRECALC_PTR(qscroll_area_recalculate);
+  widgetConfig.pfnPaint       = QPAINTER_PTR(qscroll_area_paint);
+  widgetConfig.pfnVisit       = QVISIT_PTR(qscroll_area_visit);
+  widgetConfig.pfnMeasure     = QMEASURE_PTR(qscroll_area_measure);
+
+  // Allocate the scroll area.
+  err = qcreate_widget(
+    &widgetConfig,
+    &area
+  );
+  if (err) {
+    return err;
+  }
+
+  // The area prefers the widget's bounds, but is happy to show less of it.
+  QW(area)->sizePolicy = QPOLICY_EXPANDING;
+  QP(area)->placedStale = QTRUE;
+  qwidget_set_focusable(area, QTRUE);
+  err = qwidget_connect(QW(area), on_key_press, area, qscroll_area_key_press);
+  if (err) {
+    qdestroy_scroll_area(area);
+    return err;
+  }
+
+  // Return the scroll area to the caller.
+  *pArea = area;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_scroll_area (
+  qscroll_area_t *                      pArea
+) {
+  if (QP(pArea)->pWidget) {
+    qdestroy_widget(QP(pArea)->pWidget);
+  }
+  qfree(QW(pArea)->pAllocator, pArea);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qscroll_area_set_widget (
+  qscroll_area_t *                      pArea,
+  qwidget_t *                           pWidget
+) {
+  qwidget_t * widget;
+
+  // Detach the old widget before it goes, so nothing reaches it through the area.
+  widget = QP(pArea)->pWidget;
+  if (widget) {
+    QP(pArea)->pWidget = NULL;
+    qwidget_set_parent(widget, NULL);
+    qdestroy_widget(widget);
+  }
+  QP(pArea)->pWidget = pWidget;
+  QW(pArea)->scrollOffset = qcoord(0, 0);
+  QP(pArea)->placedStale = QTRUE;
+  if (pWidget) {
+    qwidget_set_parent(pWidget, pArea);
+  }
+  else {
+    qwidget_update_geometry(pArea);
+  }
+}
+
+//------------------------------------------------------------------------------
+qcoord_t QCURSESCALL qscroll_area_get_scroll (
+  qscroll_area_t const *                pArea
+) {
+  return QW(pArea)->scrollOffset;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qscroll_area_set_scroll (
+  qscroll_area_t *                      pArea,
+  qcoord_t const *                      pOffset
+) {
+  qcoord_t offset;
+
+  offset = qscroll_area_clamp(pArea, pOffset->column, pOffset->row);
+  if (qcoord_equal(&offset, &QW(pArea)->scrollOffset)) {
+    return 0;
+  }
+
+  // Only the area is dirtied, its widget keeps its region and is simply painted elsewhere.
+  QW(pArea)->scrollOffset = offset;
+  qwidget_mark_dirty(pArea);
+  return qwidget_emit(pArea, scrolled, offset);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qscroll_area_scroll_by (
+  qscroll_area_t *                      pArea,
+  qoffset_t                             columns,
+  qoffset_t                             rows
+) {
+  qcoord_t offset;
+  offset = qscroll_area_clamp(
+    pArea,
+    (int64_t)QW(pArea)->scrollOffset.column + columns,
+    (int64_t)QW(pArea)->scrollOffset.row + rows
+  );
+  return qscroll_area_set_scroll(pArea, &offset);
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
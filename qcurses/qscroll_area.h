@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QSCROLL_AREA_H
+#define   QSCROLL_AREA_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Scroll Area Definition
+////////////////////////////////////////////////////////////////////////////////
+
+// Shows a window into a widget laid out at its full size hint (or the viewport, if larger).
+// Note: The hosted widget is not hit-tested or focused, the scroll area takes the input.
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qscroll_area_t)
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(scrolled, qcoord_t offset);
+  QWIDGET_SIGNALS_END
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// Scroll Area Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_scroll_area (
+  qalloc_t const *                      pAllocator,
+  qscroll_area_t **                     pArea
+);
+
+// Note: The scroll area owns its widget, and destroys it along with itself.
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_scroll_area (
+  qscroll_area_t *                      pArea
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qscroll_area_set_widget (
+  qscroll_area_t *                      pArea,
+  qwidget_t *                           pWidget
+);
+
+// Hosts the widget (or none, if NULL), destroying the widget hosted before.
+//------------------------------------------------------------------------------
+#define qscroll_area_set_widget(pArea, pWidget)                                 \
+  __qscroll_area_set_widget(                                                    \
+    pArea,                                                                      \
+    (qwidget_t *)(pWidget)                                                      \
+  )
+
+//------------------------------------------------------------------------------
+qcoord_t QCURSESCALL qscroll_area_get_scroll (
+  qscroll_area_t const *                pArea
+);
+
+// Moves the view without laying the widget out again (limited to the widget's bounds).
+// Note: Full-width areas scroll the terminal, and only paint the rows which were exposed.
+//------------------------------------------------------------------------------
+int QCURSESCALL qscroll_area_set_scroll (
+  qscroll_area_t *                      pArea,
+  qcoord_t const *                      pOffset
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qscroll_area_scroll_by (
+  qscroll_area_t *                      pArea,
+  qoffset_t                             columns,
+  qoffset_t                             rows
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QSCROLL_AREA_H
@@ -0,0 +1,386 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qshortcut_map.h"
+#include <string.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Shortcut Map Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+#define QSHORTCUT_ROOT                  0
+#define QSHORTCUT_INITIAL_BUCKETS       16
+
+// Each keystroke is a node in a prefix trie, chords are paths from the root.
+// The root node only exists to anchor the trie, it never has an action.
+// Note: Nodes are never removed, a node without bindings behaves as if it were absent.
+//------------------------------------------------------------------------------
+typedef struct qshortcut_node_t {
+  qshortcut_pfn                         pfnAction;
+  qwidget_t *                           pTarget;
+  uint32_t                              bindingCount;   // Bound actions at or below this node.
+} qshortcut_node_t;
+
+// The edges of the trie are stored in the hash table, keyed by the parent node.
+// Only the first keystroke of a chord is scoped, the rest are reached through it.
+//------------------------------------------------------------------------------
+typedef struct qshortcut_bucket_t {
+  qwidget_t *                           pScope;
+  uint32_t                              parent;
+  uint32_t                              node;           // QSHORTCUT_ROOT for an empty bucket.
+  qkey_t                                code;
+  qmodifier_t                           modifiers;
+} qshortcut_bucket_t;
+
+//------------------------------------------------------------------------------
+struct qshortcut_map_t {
+  qalloc_t const *                      pAllocator;
+  QDEFINE_ARRAY(qshortcut_node_t)       nodes;
+  qshortcut_bucket_t *                  pBuckets;
+  uint32_t                              bucketMask;     // Bucket capacity (power of two) - 1.
+  uint32_t                              bucketCount;
+  uint32_t                              pending;        // Node of a partial chord, or the root.
+};
+
+//------------------------------------------------------------------------------
+static inline uint32_t qshortcut_hash (
+  uint32_t                              parent,
+  qwidget_t const *                     pScope,
+  qkeystroke_t const *                  pKey
+) {
+  uint64_t hash;
+  hash  = (uint64_t)(uintptr_t)pScope * UINT64_C(0x9E3779B97F4A7C15);
+  hash ^= ((uint64_t)parent << 32) | ((uint64_t)pKey->code << 8) | (uint64_t)pKey->modifiers;
+  hash *= UINT64_C(0xBF58476D1CE4E5B9);
+  hash ^= hash >> 31;
+  return (uint32_t)hash;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t qshortcut_map_find (
+  qshortcut_map_t const *               pMap,
+  uint32_t                              parent,
+  qwidget_t const *                     pScope,
+  qkeystroke_t const *                  pKey
+) {
+  uint32_t idx;
+  qshortcut_bucket_t const * pBucket;
+
+  if (!pMap->pBuckets) {
+    return QSHORTCUT_ROOT;
+  }
+
+  // Linear probing, the load factor is kept at or below one half.
+  idx = qshortcut_hash(parent, pScope, pKey) & pMap->bucketMask;
+  for (;;) {
+    pBucket = &pMap->pBuckets[idx];
+    if (pBucket->node == QSHORTCUT_ROOT) {
+      return QSHORTCUT_ROOT;
+    }
+    if (pBucket->parent    == parent        &&
+        pBucket->pScope    == pScope        &&
+        pBucket->code      == pKey->code    &&
+        pBucket->modifiers == pKey->modifiers) {
+      return pBucket->node;
+    }
+    idx = (idx + 1) & pMap->bucketMask;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void qshortcut_map_place (
+  qshortcut_bucket_t *                  pBuckets,
+  uint32_t                              bucketMask,
+  qshortcut_bucket_t const *            pBucket
+) {
+  uint32_t idx;
+  qkeystroke_t key;
+  key.code = pBucket->code;
+  key.modifiers = pBucket->modifiers;
+  idx = qshortcut_hash(pBucket->parent, pBucket->pScope, &key) & bucketMask;
+  while (pBuckets[idx].node != QSHORTCUT_ROOT) {
+    idx = (idx + 1) & bucketMask;
+  }
+  pBuckets[idx] = *pBucket;
+}
+
+//------------------------------------------------------------------------------
+static int qshortcut_map_reserve (
+  qshortcut_map_t *                     pMap
+) {
+  uint32_t idx;
+  uint32_t capacity;
+  qshortcut_bucket_t * pBuckets;
+
+  // Nothing to do if there is still room for another edge.
+  capacity = pMap->pBuckets ? pMap->bucketMask + 1 : 0;
+  if (2 * (pMap->bucketCount + 1) <= capacity) {
+    return 0;
+  }
+  if (capacity > UINT32_MAX / 2 / sizeof(qshortcut_bucket_t)) {
+    return ERANGE;
+  }
+
+  // Re-hash every edge into a table of twice the size.
+  capacity = capacity ? 2 * capacity : QSHORTCUT_INITIAL_BUCKETS;
+  pBuckets = qallocate(pMap->pAllocator, sizeof(qshortcut_bucket_t) * capacity, 1);
+  if (!pBuckets) {
+    return ENOMEM;
+  }
+  memset(pBuckets, 0, sizeof(qshortcut_bucket_t) * capacity);
+  if (pMap->pBuckets) {
+    for (idx = 0; idx <= pMap->bucketMask; ++idx) {
+      if (pMap->pBuckets[idx].node != QSHORTCUT_ROOT) {
+        qshortcut_map_place(pBuckets, capacity - 1, &pMap->pBuckets[idx]);
+      }
+    }
+    qfree(pMap->pAllocator, pMap->pBuckets);
+  }
+  pMap->pBuckets = pBuckets;
+  pMap->bucketMask = capacity - 1;
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int qshortcut_map_add_node (
+  qshortcut_map_t *                     pMap,
+  uint32_t                              parent,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKey,
+  uint32_t *                            pNode
+) {
+  int err;
+  qshortcut_node_t node;
+  qshortcut_bucket_t bucket;
+
+  // Reserve everything first, so that a failure doesn't leave a half-made edge.
+  err = qshortcut_map_reserve(pMap);
+  if (err) {
+    return err;
+  }
+  node.pfnAction = NULL;
+  node.pTarget = NULL;
+  node.bindingCount = 0;
+  err = qarray_push(pMap->pAllocator, &pMap->nodes, node);
+  if (err) {
+    return err;
+  }
+
+  bucket.pScope = pScope;
+  bucket.parent = parent;
+  bucket.node = pMap->nodes.count - 1;
+  bucket.code = pKey->code;
+  bucket.modifiers = pKey->modifiers;
+  qshortcut_map_place(pMap->pBuckets, pMap->bucketMask, &bucket);
+  ++pMap->bucketCount;
+
+  *pNode = bucket.node;
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Shortcut Map Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_shortcut_map (
+  qalloc_t const *                      pAllocator,
+  qshortcut_map_t **                    pMap
+) {
+  int err;
+  qshortcut_map_t * map;
+  qshortcut_node_t root;
+
+  // Ensure that we are setting a valid allocator.
+  if (!pAllocator) {
+    pAllocator = qdefault_allocator();
+  }
+
+  // Zeroing out the data will set most of the map to reasonable defaults.
+  map = (qshortcut_map_t *)qallocate(pAllocator, sizeof(qshortcut_map_t), 1);
+  if (!map) {
+    return ENOMEM;
+  }
+  memset(map, 0, sizeof(qshortcut_map_t));
+  map->pAllocator = pAllocator;
+
+  // Construct the root of the trie (which is also the "no node" value).
+  memset(&root, 0, sizeof(root));
+  err = qarray_push(pAllocator, &map->nodes, root);
+  if (err) {
+    qfree(pAllocator, map);
+    return err;
+  }
+
+  *pMap = map;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_shortcut_map (
+  qshortcut_map_t *                     pMap
+) {
+  qalloc_t const * pAllocator;
+  pAllocator = pMap->pAllocator;
+  qfree(pAllocator, pMap->pBuckets);
+  qarray_deinit(pAllocator, &pMap->nodes);
+  qfree(pAllocator, pMap);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_insert (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count,
+  qwidget_t *                           pTarget,
+  qshortcut_pfn                         pfnAction
+) {
+  int err;
+  uint32_t idx;
+  uint32_t node;
+  uint32_t parent;
+
+  if (!count || !pfnAction) {
+    return EINVAL;
+  }
+
+  // Walk (or extend) the trie along the keystrokes.
+  // A chord may not pass through a bound keystroke, or end where another chord continues.
+  parent = QSHORTCUT_ROOT;
+  for (idx = 0; idx < count; ++idx) {
+    node = qshortcut_map_find(pMap, parent, idx ? NULL : pScope, &pKeys[idx]);
+    if (node == QSHORTCUT_ROOT) {
+      err = qshortcut_map_add_node(pMap, parent, idx ? NULL : pScope, &pKeys[idx], &node);
+      if (err) {
+        return err;
+      }
+    }
+    if (pMap->nodes.pData[node].pfnAction) {
+      return EEXIST;
+    }
+    parent = node;
+  }
+  if (pMap->nodes.pData[node].bindingCount) {
+    return EEXIST;
+  }
+  pMap->nodes.pData[node].pfnAction = pfnAction;
+  pMap->nodes.pData[node].pTarget = pTarget;
+
+  // Bring the path back to life (the root is skipped, it's never dispatched).
+  parent = QSHORTCUT_ROOT;
+  for (idx = 0; idx < count; ++idx) {
+    parent = qshortcut_map_find(pMap, parent, idx ? NULL : pScope, &pKeys[idx]);
+    ++pMap->nodes.pData[parent].bindingCount;
+  }
+
+  return 0;
+}
+
+// Note: The trie edges are kept, so re-binding the same sequence is cheap.
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_remove (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count
+) {
+  uint32_t idx;
+  uint32_t node;
+
+  node = QSHORTCUT_ROOT;
+  for (idx = 0; idx < count; ++idx) {
+    node = qshortcut_map_find(pMap, node, idx ? NULL : pScope, &pKeys[idx]);
+    if (node == QSHORTCUT_ROOT) {
+      return ENOENT;
+    }
+  }
+  if (!pMap->nodes.pData[node].pfnAction) {
+    return ENOENT;
+  }
+  pMap->nodes.pData[node].pfnAction = NULL;
+  pMap->nodes.pData[node].pTarget = NULL;
+
+  // Edges are kept, but ones that lead to no other binding are now inert.
+  node = QSHORTCUT_ROOT;
+  for (idx = 0; idx < count; ++idx) {
+    node = qshortcut_map_find(pMap, node, idx ? NULL : pScope, &pKeys[idx]);
+    --pMap->nodes.pData[node].bindingCount;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_dispatch (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pFocus,
+  qkey_event_t *                        pEvent
+) {
+  uint32_t node;
+  qwidget_t * pScope;
+  qkeystroke_t key;
+  qshortcut_node_t const * pNode;
+
+  key.code = pEvent->code;
+  key.modifiers = pEvent->modifiers;
+
+  // A chord in progress consumes the next key, even if the chord is then abandoned.
+  if (pMap->pending != QSHORTCUT_ROOT) {
+    node = qshortcut_map_find(pMap, pMap->pending, NULL, &key);
+    pMap->pending = QSHORTCUT_ROOT;
+    pEvent->accepted = QTRUE;
+  }
+
+  // Otherwise, the innermost scope containing the focus wins (ending with global).
+  else {
+    pScope = pFocus;
+    for (;;) {
+      node = qshortcut_map_find(pMap, QSHORTCUT_ROOT, pScope, &key);
+      if (pMap->nodes.pData[node].bindingCount || !pScope) {
+        break;
+      }
+      pScope = pScope->pParent;
+    }
+  }
+  pNode = &pMap->nodes.pData[node];
+  if (!pNode->bindingCount) {
+    return 0;
+  }
+
+  // Either wait for the rest of the chord, or invoke the action.
+  pEvent->accepted = QTRUE;
+  if (!pNode->pfnAction) {
+    pMap->pending = node;
+    return 0;
+  }
+  return pNode->pfnAction(pNode->pTarget);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qshortcut_map_cancel (
+  qshortcut_map_t *                     pMap
+) {
+  pMap->pending = QSHORTCUT_ROOT;
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QSHORTCUT_MAP_H
+#define   QSHORTCUT_MAP_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Shortcut Map Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qkeystroke_t);
+QDECLARE_STRUCT(qshortcut_map_t);
+
+// Actions are slots without parameters, see QSLOT_VOID.
+typedef int (QCURSESPTR *qshortcut_pfn)(qwidget_t *);
+
+////////////////////////////////////////////////////////////////////////////////
+// Shortcut Map Structures
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+struct qkeystroke_t {
+  qkey_t                                code;
+  qmodifier_t                           modifiers;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Shortcut Map Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_shortcut_map (
+  qalloc_t const *                      pAllocator,
+  qshortcut_map_t **                    pMap
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_shortcut_map (
+  qshortcut_map_t *                     pMap
+);
+
+// Binds a sequence of keystrokes (a chord when count > 1) to an action.
+// A scope limits the shortcut to when the scope (or a descendant) has focus.
+// Returns EEXIST if the sequence is bound, or is a prefix of (or prefixed by) a binding.
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_insert (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count,
+  qwidget_t *                           pTarget,
+  qshortcut_pfn                         pfnAction
+);
+
+// Unbinds the action, returns ENOENT if the sequence was not bound.
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_remove (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pScope,
+  qkeystroke_t const *                  pKeys,
+  uint32_t                              count
+);
+
+// Looks up the key event, from the focused scope outwards to the global scope.
+// Sets accepted if the key was consumed (by an action, or as part of a chord).
+//------------------------------------------------------------------------------
+int QCURSESCALL qshortcut_map_dispatch (
+  qshortcut_map_t *                     pMap,
+  qwidget_t *                           pFocus,
+  qkey_event_t *                        pEvent
+);
+
+// Abandons a partially entered chord.
+//------------------------------------------------------------------------------
+void QCURSESCALL qshortcut_map_cancel (
+  qshortcut_map_t *                     pMap
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QSHORTCUT_MAP_H
@@ -0,0 +1,514 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qspatial_index.h"
+#include <string.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Spatial Index Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// Note: Entries are never moved, so the cells can refer to them by index.
+//       Hidden widgets keep their entry (and painting order) with an empty region.
+//       Widgets which left the tree leave a free entry behind.
+//------------------------------------------------------------------------------
+typedef struct qspatial_entry_t {
+  qwidget_t *                           pWidget;        // NULL for a free entry.
+  qregion_t                             region;         // Outer region on screen, clipped by the parents and the grid.
+  qcoord_t                              origin;         // Where the outer region starts on screen (may be clipped away).
+  qregion_t                             placed;         // The outer region the widget had, before moving and clipping.
+  qcoord_t                              offset;         // What the parents moved it by.
+  qregion_t                             clip;           // What the parents clipped it by.
+  qbool_t                               shown;          // The widget and all of its parents are visible.
+  uint32_t                              order;          // Painting order, larger is on top.
+  uint32_t                              stamp;          // The last full update to visit the entry.
+  uint32_t                              nextFree;
+} qspatial_entry_t;
+
+//------------------------------------------------------------------------------
+typedef QDEFINE_ARRAY(uint32_t) qspatial_cell_t;
+
+//------------------------------------------------------------------------------
+struct qspatial_index_t {
+  qalloc_t const *                      pAllocator;
+  qregion_t                             area;
+  uint32_t                              gridRows;
+  uint32_t                              gridColumns;
+  uint32_t                              cellCount;
+  qspatial_cell_t *                     pCells;
+  QDEFINE_ARRAY(qspatial_entry_t)       entries;
+  uint32_t                              freeEntry;
+  uint32_t                              stamp;
+  uint32_t                              order;
+  uint32_t                              generation;     // The tree generation of the last full update.
+  qbool_t                               isStale;        // Every widget has to be visited again.
+};
+
+// Scrolling parents move their children, and every parent clips its children.
+//------------------------------------------------------------------------------
+typedef struct qspatial_visit_t {
+  qspatial_index_t *                    pIndex;
+  qbool_t                               isFull;         // Visits every widget, rather than only those which moved.
+  qbool_t                               shown;
+  qcoord_t                              offset;         // Added to the regions of the widgets visited.
+  qregion_t                             clip;
+} qspatial_visit_t;
+
+// The inclusive range of grid cells overlapped by a (non-empty, clipped) region.
+//------------------------------------------------------------------------------
+typedef struct qspatial_range_t {
+  uint32_t                              firstRow;
+  uint32_t                              firstColumn;
+  uint32_t                              lastRow;
+  uint32_t                              lastColumn;
+} qspatial_range_t;
+
+//------------------------------------------------------------------------------
+static inline qspatial_range_t qspatial_index_range (
+  qregion_t const *                     pRegion
+) {
+  qspatial_range_t range;
+  range.firstRow    = (uint32_t)pRegion->coord.row / QSPATIAL_CELL_ROWS;
+  range.firstColumn = (uint32_t)pRegion->coord.column / QSPATIAL_CELL_COLUMNS;
+  range.lastRow     = ((uint32_t)pRegion->coord.row + pRegion->bounds.rows - 1) / QSPATIAL_CELL_ROWS;
+  range.lastColumn  = ((uint32_t)pRegion->coord.column + pRegion->bounds.columns - 1) / QSPATIAL_CELL_COLUMNS;
+  return range;
+}
+
+//------------------------------------------------------------------------------
+static int qspatial_index_insert_cells (
+  qspatial_index_t *                    pIndex,
+  uint32_t                              entry
+) {
+  int err;
+  uint32_t row;
+  uint32_t column;
+  qspatial_range_t range;
+  qregion_t const * pRegion;
+
+  pRegion = &pIndex->entries.pData[entry].region;
+  if (qregion_empty(pRegion)) {
+    return 0;
+  }
+
+  // Note: On failure the entry is left partially indexed, removal tolerates this.
+  range = qspatial_index_range(pRegion);
+  for (row = range.firstRow; row <= range.lastRow; ++row) {
+    for (column = range.firstColumn; column <= range.lastColumn; ++column) {
+      err = qarray_push(
+        pIndex->pAllocator,
+        &pIndex->pCells[row * pIndex->gridColumns + column],
+        entry
+      );
+      if (err) {
+        return err;
+      }
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void qspatial_index_remove_cells (
+  qspatial_index_t *                    pIndex,
+  uint32_t                              entry
+) {
+  uint32_t idx;
+  uint32_t row;
+  uint32_t column;
+  qspatial_range_t range;
+  qspatial_cell_t * pCell;
+  qregion_t const * pRegion;
+
+  pRegion = &pIndex->entries.pData[entry].region;
+  if (qregion_empty(pRegion)) {
+    return;
+  }
+
+  // Cells are unordered (painting order is kept per-entry), so swap-remove.
+  range = qspatial_index_range(pRegion);
+  for (row = range.firstRow; row <= range.lastRow; ++row) {
+    for (column = range.firstColumn; column <= range.lastColumn; ++column) {
+      pCell = &pIndex->pCells[row * pIndex->gridColumns + column];
+      for (idx = 0; idx < pCell->count; ++idx) {
+        if (pCell->pData[idx] == entry) {
+          pCell->pData[idx] = pCell->pData[--pCell->count];
+          break;
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int qspatial_index_resize (
+  qspatial_index_t *                    pIndex,
+  qbounds_t const *                     pBounds
+) {
+  uint32_t idx;
+  uint32_t gridRows;
+  uint32_t gridColumns;
+  uint64_t cellCount;
+  qspatial_cell_t * pCells;
+
+  // Calculate the number of cells required to cover the new bounds.
+  gridRows    = (uint32_t)(((uint64_t)pBounds->rows    + QSPATIAL_CELL_ROWS    - 1) / QSPATIAL_CELL_ROWS);
+  gridColumns = (uint32_t)(((uint64_t)pBounds->columns + QSPATIAL_CELL_COLUMNS - 1) / QSPATIAL_CELL_COLUMNS);
+  cellCount   = (uint64_t)gridRows * gridColumns;
+  if (cellCount > UINT32_MAX / sizeof(qspatial_cell_t)) {
+    return ERANGE;
+  }
+
+  // Release the cells we no longer need, and grow the cells which we do.
+  for (idx = (uint32_t)cellCount; idx < pIndex->cellCount; ++idx) {
+    qarray_deinit(pIndex->pAllocator, &pIndex->pCells[idx]);
+  }
+  if (cellCount > pIndex->cellCount) {
+    pCells = qreallocate(
+      pIndex->pAllocator,
+      pIndex->pCells,
+      sizeof(qspatial_cell_t) * cellCount
+    );
+    if (!pCells) {
+      return ENOMEM;
+    }
+    memset(&pCells[pIndex->cellCount], 0, sizeof(qspatial_cell_t) * (cellCount - pIndex->cellCount));
+    pIndex->pCells = pCells;
+  }
+  pIndex->cellCount   = (uint32_t)cellCount;
+  pIndex->gridRows    = gridRows;
+  pIndex->gridColumns = gridColumns;
+  pIndex->area        = qregion(0, 0, pBounds->rows, pBounds->columns);
+
+  // Every cell maps to a different part of the screen now, so start them over.
+  // Entries are given an empty region, which forces them to be re-inserted.
+  for (idx = 0; idx < pIndex->cellCount; ++idx) {
+    qarray_clear(&pIndex->pCells[idx]);
+  }
+  for (idx = 0; idx < pIndex->entries.count; ++idx) {
+    pIndex->entries.pData[idx].region = qregion(0, 0, 0, 0);
+  }
+  pIndex->isStale = QTRUE;
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t qspatial_index_find (
+  qspatial_index_t const *              pIndex,
+  qwidget_t const *                     pWidget
+) {
+  uint32_t entry;
+
+  // The back-pointer is checked since the widget may belong to another index.
+  entry = pWidget->spatialEntry;
+  if (entry >= pIndex->entries.count || pIndex->entries.pData[entry].pWidget != pWidget) {
+    return QSPATIAL_ENTRY_NONE;
+  }
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+static void qspatial_index_release (
+  qspatial_index_t *                    pIndex,
+  uint32_t                              entry
+) {
+  qspatial_entry_t * pEntry;
+  pEntry = &pIndex->entries.pData[entry];
+  qspatial_index_remove_cells(pIndex, entry);
+  pEntry->pWidget = NULL;
+  pEntry->nextFree = pIndex->freeEntry;
+  pIndex->freeEntry = entry;
+}
+
+//------------------------------------------------------------------------------
+static int qspatial_index_track (
+  qspatial_index_t *                    pIndex,
+  qwidget_t *                           pWidget,
+  qspatial_visit_t const *              pParent,
+  qregion_t const *                     pRegion,
+  qcoord_t                              origin,
+  qbool_t                               shown
+) {
+  int err;
+  uint32_t entry;
+  qspatial_entry_t * pEntry;
+  qspatial_entry_t newEntry;
+
+  // Find the widget's entry, or reserve a new entry if it isn't indexed yet.
+  // Note: New entries are placed on top, until the next full update puts them in painting order.
+  entry = qspatial_index_find(pIndex, pWidget);
+  if (entry == QSPATIAL_ENTRY_NONE) {
+    if (pIndex->freeEntry != QSPATIAL_ENTRY_NONE) {
+      entry = pIndex->freeEntry;
+      pIndex->freeEntry = pIndex->entries.pData[entry].nextFree;
+    }
+    else {
+      newEntry.pWidget = NULL;
+      err = qarray_push(pIndex->pAllocator, &pIndex->entries, newEntry);
+      if (err) {
+        return err;
+      }
+      entry = pIndex->entries.count - 1;
+    }
+    pEntry = &pIndex->entries.pData[entry];
+    pEntry->pWidget = pWidget;
+    pEntry->region = qregion(0, 0, 0, 0);
+    pEntry->order = pIndex->order++;
+    pEntry->nextFree = QSPATIAL_ENTRY_NONE;
+    pWidget->spatialEntry = entry;
+  }
+
+  // Record the visit, and only touch the grid if the region has actually changed.
+  pEntry = &pIndex->entries.pData[entry];
+  if (pParent->isFull) {
+    pEntry->stamp = pIndex->stamp;
+    pEntry->order = pIndex->order++;
+  }
+  pEntry->origin = origin;
+  pEntry->placed = pWidget->outerRegion;
+  pEntry->offset = pParent->offset;
+  pEntry->clip = pParent->clip;
+  pEntry->shown = shown;
+  if (qregion_equal(pRegion, &pEntry->region)) {
+    return 0;
+  }
+  qspatial_index_remove_cells(pIndex, entry);
+  pEntry->region = *pRegion;
+  return qspatial_index_insert_cells(pIndex, entry);
+}
+
+//------------------------------------------------------------------------------
+static int qspatial_index_visit (
+  qwidget_t *                           pWidget,
+  void *                                pUserData
+) {
+  int err;
+  uint32_t entry;
+  qbool_t shown;
+  qregion_t region;
+  qspatial_visit_t visit;
+  qspatial_visit_t const * pParent;
+  qspatial_entry_t const * pEntry;
+
+  // A clean widget placed the same way within the same window kept its region, and so did its children.
+  // Note: Children only move when their parent is recalculated, which dirties it or changes its region.
+  pParent = (qspatial_visit_t const *)pUserData;
+  shown = QBOOL(pParent->shown && qwidget_is_visible(pWidget));
+  entry = qspatial_index_find(pParent->pIndex, pWidget);
+  if (!pParent->isFull && entry != QSPATIAL_ENTRY_NONE && !qwidget_is_dirty(pWidget)) {
+    pEntry = &pParent->pIndex->entries.pData[entry];
+    if (
+      pEntry->shown == shown &&
+      qregion_equal(&pEntry->placed, &pWidget->outerRegion) &&
+      qcoord_equal(&pEntry->offset, &pParent->offset) &&
+      qregion_equal(&pEntry->clip, &pParent->clip)
+    ) {
+      return 0;
+    }
+  }
+
+  // Only the part of the widget which its parents show on screen can be hit, and nothing of a hidden one.
+  region = pWidget->outerRegion;
+  region.coord.column += pParent->offset.column;
+  region.coord.row    += pParent->offset.row;
+  visit.clip = shown ? qregion_intersect(&region, &pParent->clip) : qregion(0, 0, 0, 0);
+  err = qspatial_index_track(pParent->pIndex, pWidget, pParent, &visit.clip, region.coord, shown);
+  if (err) {
+    return err;
+  }
+
+  // Note: Most widgets don't scroll, so their children stay where the widget placed them.
+  visit.pIndex = pParent->pIndex;
+  visit.isFull = pParent->isFull;
+  visit.shown  = shown;
+  visit.offset = qcoord(
+    pParent->offset.column - pWidget->scrollOffset.column,
+    pParent->offset.row    - pWidget->scrollOffset.row
+  );
+  return qwidget_visit(pWidget, &qspatial_index_visit, &visit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Spatial Index Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_spatial_index (
+  qalloc_t const *                      pAllocator,
+  qspatial_index_t **                   pIndex
+) {
+  qspatial_index_t * index;
+
+  // Ensure that we are setting a valid allocator.
+  if (!pAllocator) {
+    pAllocator = qdefault_allocator();
+  }
+
+  // Zeroing out the data will set most of the index to reasonable defaults.
+  index = (qspatial_index_t *)qallocate(pAllocator, sizeof(qspatial_index_t), 1);
+  if (!index) {
+    return ENOMEM;
+  }
+  memset(index, 0, sizeof(qspatial_index_t));
+  index->pAllocator = pAllocator;
+  index->freeEntry = QSPATIAL_ENTRY_NONE;
+  index->isStale = QTRUE;
+
+  *pIndex = index;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_spatial_index (
+  qspatial_index_t *                    pIndex
+) {
+  uint32_t idx;
+  qalloc_t const * pAllocator;
+  pAllocator = pIndex->pAllocator;
+  for (idx = 0; idx < pIndex->cellCount; ++idx) {
+    qarray_deinit(pAllocator, &pIndex->pCells[idx]);
+  }
+  qfree(pAllocator, pIndex->pCells);
+  qarray_deinit(pAllocator, &pIndex->entries);
+  qfree(pAllocator, pIndex);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qspatial_index_update (
+  qspatial_index_t *                    pIndex,
+  qwidget_t *                           pRoot,
+  qbounds_t const *                     pBounds
+) {
+  int err;
+  uint32_t idx;
+  qspatial_visit_t visit;
+  qspatial_entry_t * pEntry;
+
+  // A change in screen size changes the meaning of every cell.
+  if (!qbounds_equal(&pIndex->area.bounds, pBounds)) {
+    err = qspatial_index_resize(pIndex, pBounds);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Usually only the widgets which moved are visited, their painting order is still the same.
+  // When the tree itself changed, every widget is visited in painting order, so later widgets are on top.
+  visit.pIndex = pIndex;
+  visit.isFull = QBOOL(pIndex->isStale || pIndex->generation != qwidget_tree_generation());
+  visit.shown  = QTRUE;
+  visit.offset = qcoord(0, 0);
+  visit.clip   = pIndex->area;
+  if (!visit.isFull) {
+    return qspatial_index_visit(pRoot, &visit);
+  }
+  ++pIndex->stamp;
+  pIndex->order = 0;
+  err = qspatial_index_visit(pRoot, &visit);
+  if (err) {
+    return err;
+  }
+  pIndex->generation = qwidget_tree_generation();
+  pIndex->isStale = QFALSE;
+
+  // Anything not visited has left the tree, so release the entry.
+  // Note: The widget may have been destroyed since, so only the entry can be touched.
+  for (idx = 0; idx < pIndex->entries.count; ++idx) {
+    pEntry = &pIndex->entries.pData[idx];
+    if (pEntry->pWidget && pEntry->stamp != pIndex->stamp) {
+      qspatial_index_release(pIndex, idx);
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qspatial_index_remove (
+  qspatial_index_t *                    pIndex,
+  qwidget_t *                           pWidget
+) {
+  uint32_t entry;
+  entry = qspatial_index_find(pIndex, pWidget);
+  if (entry != QSPATIAL_ENTRY_NONE) {
+    qspatial_index_release(pIndex, entry);
+  }
+  pWidget->spatialEntry = QSPATIAL_ENTRY_NONE;
+}
+
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qspatial_index_hit_test (
+  qspatial_index_t const *              pIndex,
+  qcoord_t const *                      pCoord
+) {
+  uint32_t idx;
+  qspatial_cell_t const * pCell;
+  qspatial_entry_t const * pEntry;
+  qspatial_entry_t const * pBest;
+
+  if (!qregion_contains(&pIndex->area, pCoord)) {
+    return NULL;
+  }
+
+  // Only the entries overlapping the coordinate's cell need to be checked.
+  pCell = &pIndex->pCells[
+    ((uint32_t)pCoord->row / QSPATIAL_CELL_ROWS) * pIndex->gridColumns +
+    ((uint32_t)pCoord->column / QSPATIAL_CELL_COLUMNS)
+  ];
+  pBest = NULL;
+  for (idx = 0; idx < pCell->count; ++idx) {
+    pEntry = &pIndex->entries.pData[pCell->pData[idx]];
+    if (!qregion_contains(&pEntry->region, pCoord)) {
+      continue;
+    }
+    if (!pBest || pEntry->order > pBest->order) {
+      pBest = pEntry;
+    }
+  }
+
+  return pBest ? pBest->pWidget : NULL;
+}
+
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL __qspatial_index_contains (
+  qspatial_index_t const *              pIndex,
+  qwidget_t const *                     pWidget
+) {
+  uint32_t entry;
+  entry = qspatial_index_find(pIndex, pWidget);
+  return QBOOL(entry != QSPATIAL_ENTRY_NONE && pIndex->entries.pData[entry].shown);
+}
+
+//------------------------------------------------------------------------------
+qcoord_t QCURSESCALL __qspatial_index_origin (
+  qspatial_index_t const *              pIndex,
+  qwidget_t const *                     pWidget
+) {
+  if (!qspatial_index_contains(pIndex, pWidget)) {
+    return pWidget->outerRegion.coord;
+  }
+  return pIndex->entries.pData[pWidget->spatialEntry].origin;
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
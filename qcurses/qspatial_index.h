@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QSPATIAL_INDEX_H
+#define   QSPATIAL_INDEX_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Spatial Index Defines
+////////////////////////////////////////////////////////////////////////////////
+
+// The screen is split into a uniform grid of cells this size.
+// Terminal cells are roughly twice as tall as they are wide, so cells are wider.
+//------------------------------------------------------------------------------
+#define QSPATIAL_CELL_ROWS              4
+#define QSPATIAL_CELL_COLUMNS           8
+
+////////////////////////////////////////////////////////////////////////////////
+// Spatial Index Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qspatial_index_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Spatial Index Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_spatial_index (
+  qalloc_t const *                      pAllocator,
+  qspatial_index_t **                   pIndex
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_spatial_index (
+  qspatial_index_t *                    pIndex
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qspatial_index_update (
+  qspatial_index_t *                    pIndex,
+  qwidget_t *                           pRoot,
+  qbounds_t const *                     pBounds
+);
+
+// Re-indexes the visible widgets under pRoot, call this after recalculating (and before painting).
+// Only dirty widgets, and those whose region or window changed, are visited - unless the tree changed.
+// Note: The regions are indexed as shown, moved by the parents' scroll offsets and clipped by the parents.
+//------------------------------------------------------------------------------
+#define qspatial_index_update(pIndex, pRoot, pBounds)                           \
+  __qspatial_index_update(                                                      \
+    pIndex,                                                                     \
+    (qwidget_t *)(pRoot),                                                       \
+    pBounds                                                                     \
+  )
+
+// Returns the topmost (last painted) widget containing the coordinate, or NULL.
+// Note: Widgets taken out of the tree since the last update may still be returned, destroyed ones are not.
+//------------------------------------------------------------------------------
+qwidget_t * QCURSESCALL qspatial_index_hit_test (
+  qspatial_index_t const *              pIndex,
+  qcoord_t const *                      pCoord
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qspatial_index_remove (
+  qspatial_index_t *                    pIndex,
+  qwidget_t *                           pWidget
+);
+
+// Forgets the widget (not its children), which the application does for every widget destroyed.
+//------------------------------------------------------------------------------
+#define qspatial_index_remove(pIndex, pWidget)                                  \
+  __qspatial_index_remove(                                                      \
+    pIndex,                                                                     \
+    (qwidget_t *)(pWidget)                                                      \
+  )
+
+// Returns whether the widget was visible within the last update.
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL __qspatial_index_contains (
+  qspatial_index_t const *              pIndex,
+  qwidget_t const *                     pWidget
+);
+
+//------------------------------------------------------------------------------
+#define qspatial_index_contains(pIndex, pWidget)                                \
+  __qspatial_index_contains(                                                    \
+    pIndex,                                                                     \
+    (qwidget_t const *)(pWidget)                                                \
+  )
+
+//------------------------------------------------------------------------------
+qcoord_t QCURSESCALL __qspatial_index_origin (
+  qspatial_index_t const *              pIndex,
+  qwidget_t const *                     pWidget
+);
+
+// Returns where the widget's outer region starts on screen, which differs from it within a scrolled parent.
+// Note: Widgets which were not visible within the last update return their outer region's coordinate.
+//------------------------------------------------------------------------------
+#define qspatial_index_origin(pIndex, pWidget)                                  \
+  __qspatial_index_origin(                                                      \
+    pIndex,                                                                     \
+    (qwidget_t const *)(pWidget)                                                \
+  )
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QSPATIAL_INDEX_H
@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "qstring.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// String Functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Formatted text shorter than this is written to the stack first, rather than behind the contents.
+#define QSTRING_PRINTF_CAPACITY         64
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_init (
+  qstring_t *                           pString
+) {
+  pString->length = 0;
+  pString->capacity = QSTRING_LOCAL_CAPACITY;
+  pString->data.local[0] = '\0';
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_deinit (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString
+) {
+  if (pString->capacity > QSTRING_LOCAL_CAPACITY) {
+    qfree(pAllocator, pString->data.pHeap);
+  }
+  qstring_init(pString);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_reserve (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  size_t                                capacity
+) {
+  char * pData;
+  size_t newCapacity;
+
+  // Local storage, or a large enough buffer, need nothing.
+  if (capacity <= QMAX(pString->capacity, QSTRING_LOCAL_CAPACITY)) {
+    return 0;
+  }
+  if (capacity >= UINT32_MAX) {
+    return ERANGE;
+  }
+
+  // Grow geometrically, so that appending repeatedly is amortized.
+  newCapacity = QMAX(pString->capacity, QSTRING_LOCAL_CAPACITY);
+  while (newCapacity < capacity) {
+    newCapacity = QMIN(2 * newCapacity + 1, (size_t)UINT32_MAX - 1);
+  }
+
+  // Local strings are moved into the new buffer, heap strings can simply be reallocated.
+  if (pString->capacity > QSTRING_LOCAL_CAPACITY) {
+    pData = qreallocate(pAllocator, pString->data.pHeap, newCapacity + 1);
+    if (!pData) {
+      return ENOMEM;
+    }
+  }
+  else {
+    pData = qallocate(pAllocator, newCapacity + 1, 1);
+    if (!pData) {
+      return ENOMEM;
+    }
+    memcpy(pData, pString->data.local, pString->length + 1);
+  }
+
+  pString->data.pHeap = pData;
+  pString->capacity = (uint32_t)newCapacity;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_assign_n (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          text,
+  size_t                                n
+) {
+  int err;
+  char * pData;
+
+  // Note: The contents are only replaced once there's room, so failing leaves them as they were.
+  err = qstring_reserve(pAllocator, pString, n);
+  if (err) {
+    return err;
+  }
+
+  pData = qstring_data(pString);
+  memmove(pData, text, n);
+  pData[n] = '\0';
+  pString->length = (uint32_t)n;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_append_n (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          text,
+  size_t                                n
+) {
+  int err;
+  char * pData;
+
+  err = qstring_reserve(pAllocator, pString, (size_t)pString->length + n);
+  if (err) {
+    return err;
+  }
+
+  pData = qstring_data(pString);
+  memcpy(pData + pString->length, text, n);
+  pString->length += (uint32_t)n;
+  pData[pString->length] = '\0';
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_vprintf (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          format,
+  va_list                               args
+) {
+  int err;
+  int length;
+  va_list retry;
+  char buffer[QSTRING_PRINTF_CAPACITY];
+
+  // Short text is formatted on the stack and copied in, so it stays in the local storage.
+  va_copy(retry, args);
+  length = vsnprintf(buffer, sizeof(buffer), format, args);
+  if (length >= 0 && (size_t)length < sizeof(buffer)) {
+    va_end(retry);
+    return qstring_assign_n(pAllocator, pString, buffer, (size_t)length);
+  }
+
+  // Longer text is formatted into the capacity behind the contents, so that failing leaves them as they were.
+  err = (length < 0) ? EINVAL : qstring_reserve(pAllocator, pString, pString->length + 1 + (size_t)length);
+  if (!err) {
+    length = vsnprintf(qstring_data(pString) + pString->length + 1, (size_t)length + 1, format, retry);
+    err = (length < 0) ? EINVAL : 0;
+  }
+  va_end(retry);
+  if (err) {
+    return err;
+  }
+
+  memmove(qstring_data(pString), qstring_data(pString) + pString->length + 1, (size_t)length + 1);
+  pString->length = (uint32_t)length;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_erase_front (
+  qstring_t *                           pString,
+  size_t                                n
+) {
+  char * pData;
+
+  n = QMIN(n, pString->length);
+  pData = qstring_data(pString);
+  memmove(pData, pData + n, pString->length - n + 1);
+  pString->length -= (uint32_t)n;
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
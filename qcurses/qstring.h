@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QSTRING_H
+#define   QSTRING_H
+
+#include "qcurses.h"
+#include <stdarg.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// String Defines
+////////////////////////////////////////////////////////////////////////////////
+
+// Strings up to this length are stored within the string itself, without allocating.
+// Chosen so that the whole structure is 48 bytes, which fits most labels.
+//------------------------------------------------------------------------------
+#define QSTRING_LOCAL_CAPACITY          39
+
+////////////////////////////////////////////////////////////////////////////////
+// String Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+QDECLARE_STRUCT(qstring_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// String Structures
+////////////////////////////////////////////////////////////////////////////////
+
+// A null-terminated string, which allocates only once it outgrows its local storage.
+// Note: A zero-initialized string is a valid empty string.
+//------------------------------------------------------------------------------
+struct qstring_t {
+  uint32_t                              length;
+  uint32_t                              capacity;       // Excluding the null-terminator.
+  union {
+    char *                              pHeap;          // Once capacity > QSTRING_LOCAL_CAPACITY.
+    char                                local[QSTRING_LOCAL_CAPACITY + 1];
+  } data;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// String Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+static inline char * qstring_data (
+  qstring_t *                           pString
+) {
+  return (pString->capacity > QSTRING_LOCAL_CAPACITY) ? pString->data.pHeap : pString->data.local;
+}
+
+//------------------------------------------------------------------------------
+static inline size_t qstring_length (
+  qstring_t const *                     pString
+) {
+  return pString->length;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_init (
+  qstring_t *                           pString
+);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_deinit (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString
+);
+
+// Makes room for at least capacity characters, the contents are kept.
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_reserve (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  size_t                                capacity
+);
+
+// Replaces the contents, the capacity is kept so that reassigning similar text never allocates.
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_assign_n (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          text,
+  size_t                                n
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_append_n (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          text,
+  size_t                                n
+);
+
+// Replaces the contents with the formatted text, short text (e.g. a number) stays in the local storage.
+// Note: On failure (ENOMEM, or EINVAL for an encoding error) the contents are left as they were.
+//------------------------------------------------------------------------------
+int QCURSESCALL qstring_vprintf (
+  qalloc_t const *                      pAllocator,
+  qstring_t *                           pString,
+  char const *                          format,
+  va_list                               args
+);
+
+// Removes the first n characters (or all of them, if there are fewer).
+//------------------------------------------------------------------------------
+void QCURSESCALL qstring_erase_front (
+  qstring_t *                           pString,
+  size_t                                n
+);
+
+//------------------------------------------------------------------------------
+#define qstring_clear(pString)                                                  \
+  qstring_erase_front(pString, (pString)->length)
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QSTRING_H
@@ -0,0 +1,797 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qtable_view.h"
+#include "qpainter.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Table View Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// Column widths are measured from this many rows, spread evenly over the model.
+#define QTABLE_SAMPLE_ROWS              64
+#define QTABLE_MAX_WIDTH                32
+
+// How many rows are merged between checks for a cancelled sort.
+#define QTABLE_CANCEL_STRIDE            4096
+
+// Owned by the worker thread until finished is set, and by the UI thread after.
+//------------------------------------------------------------------------------
+typedef struct qtable_sort_t {
+  qtable_view_t *                       pTable;
+  uint64_t *                            pOrder;         // View row to model row (the result).
+  uint64_t *                            pScratch;
+  uint64_t                              count;
+  uint32_t                              column;
+  qbool_t                               descending;
+  qtable_compare_pfn                    pfnCompare;
+  void *                                pUserData;
+  pthread_t                             worker;
+  atomic_bool                           cancelled;
+  atomic_bool                           finished;
+} qtable_sort_t;
+
+// Note: Unless repaintAll is set, only the stale rows are painted again.
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qtable_view_t) {
+  qmodel_t *                            pModel;
+  uint64_t                              rowCount;
+  uint32_t                              columnCount;
+  uint64_t                              rowOffset;
+  uint32_t                              columnOffset;
+  uint32_t                              columnEnd;      // One past the last column painted.
+  QDEFINE_ARRAY(qextent_t)              widths;         // Zero until the column is first shown.
+  QDEFINE_ARRAY(qbool_t)                staleRows;      // Visible rows whose data changed since painted.
+  qbool_t                               repaintAll;
+  uint64_t *                            pOrder;         // NULL while shown in the model order.
+  uint32_t                              sortColumn;
+  qtable_sort_t *                       pSort;          // The running sort (if any).
+};
+
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(scrolled, uint64_t, uint32_t);
+QDEFINE_EMITTER(sorted, uint32_t);
+
+// Everything shown is painted again, rather than only the stale rows.
+//------------------------------------------------------------------------------
+static void qtable_view_repaint_all (
+  qtable_view_t *                       pTable
+) {
+  QP(pTable)->repaintAll = QTRUE;
+  qwidget_mark_dirty(pTable);
+}
+
+//------------------------------------------------------------------------------
+static void qtable_sort_free (
+  qalloc_t const *                      pAllocator,
+  qtable_sort_t *                       pSort
+) {
+  if (pSort->pScratch) {
+    qfree(pAllocator, pSort->pScratch);
+  }
+  if (pSort->pOrder) {
+    qfree(pAllocator, pSort->pOrder);
+  }
+  qfree(pAllocator, pSort);
+}
+
+// Returns to showing the rows in the model order.
+//------------------------------------------------------------------------------
+static void qtable_view_drop_order (
+  qtable_view_t *                       pTable
+) {
+  if (QP(pTable)->pOrder) {
+    qfree(QW(pTable)->pAllocator, QP(pTable)->pOrder);
+    QP(pTable)->pOrder = NULL;
+  }
+}
+
+// Merges [lo, mid) and [mid, hi) of pSource into pDest, keeping equal rows in order.
+//------------------------------------------------------------------------------
+static qbool_t qtable_sort_merge (
+  qtable_sort_t *                       pSort,
+  uint64_t const *                      pSource,
+  uint64_t *                            pDest,
+  uint64_t                              lo,
+  uint64_t                              mid,
+  uint64_t                              hi
+) {
+  int order;
+  uint64_t left;
+  uint64_t right;
+  uint64_t out;
+
+  left = lo;
+  right = mid;
+  for (out = lo; out < hi; ++out) {
+    if ((out & (QTABLE_CANCEL_STRIDE - 1)) == 0 &&
+        atomic_load_explicit(&pSort->cancelled, memory_order_relaxed)) {
+      return QFALSE;
+    }
+    if (left < mid && right < hi) {
+      order = pSort->pfnCompare(pSort->pUserData, pSort->column, pSource[left], pSource[right]);
+      if (pSort->descending ? order >= 0 : order <= 0) {
+        pDest[out] = pSource[left++];
+      }
+      else {
+        pDest[out] = pSource[right++];
+      }
+    }
+    else if (left < mid) {
+      pDest[out] = pSource[left++];
+    }
+    else {
+      pDest[out] = pSource[right++];
+    }
+  }
+
+  return QTRUE;
+}
+
+// A bottom-up merge sort, so that it's stable and can give up between any two merges.
+//------------------------------------------------------------------------------
+static void * qtable_sort_main (
+  void *                                pData
+) {
+  uint64_t idx;
+  uint64_t width;
+  uint64_t * pSource;
+  uint64_t * pDest;
+  uint64_t * pSwap;
+  qtable_sort_t * pSort;
+
+  pSort = pData;
+  for (idx = 0; idx < pSort->count; ++idx) {
+    if ((idx & (QTABLE_CANCEL_STRIDE - 1)) == 0 &&
+        atomic_load_explicit(&pSort->cancelled, memory_order_relaxed)) {
+      return NULL;
+    }
+    pSort->pOrder[idx] = idx;
+  }
+
+  pSource = pSort->pOrder;
+  pDest = pSort->pScratch;
+  for (width = 1; width < pSort->count; width *= 2) {
+    for (idx = 0; idx < pSort->count; idx += 2 * width) {
+      if (!qtable_sort_merge(
+        pSort,
+        pSource,
+        pDest,
+        idx,
+        QMIN(idx + width, pSort->count),
+        QMIN(idx + 2 * width, pSort->count)
+      )) {
+        return NULL;
+      }
+    }
+    pSwap = pSource;
+    pSource = pDest;
+    pDest = pSwap;
+  }
+
+  // The result ends up in either buffer, so make sure pOrder is the one holding it.
+  pSort->pScratch = pDest;
+  pSort->pOrder = pSource;
+  atomic_store_explicit(&pSort->finished, QTRUE, memory_order_release);
+  (void)qwidget_post_update(pSort->pTable);
+  return NULL;
+}
+
+// Stops the running sort (if any), and throws away its result.
+//------------------------------------------------------------------------------
+static void qtable_view_cancel_sort (
+  qtable_view_t *                       pTable
+) {
+  if (!QP(pTable)->pSort) {
+    return;
+  }
+  atomic_store_explicit(&QP(pTable)->pSort->cancelled, QTRUE, memory_order_relaxed);
+  pthread_join(QP(pTable)->pSort->worker, NULL);
+  qtable_sort_free(QW(pTable)->pAllocator, QP(pTable)->pSort);
+  QP(pTable)->pSort = NULL;
+  qwidget_end_background();
+}
+
+// Swaps the order of a finished sort in, the old order is only released here (UI thread).
+//------------------------------------------------------------------------------
+static int qtable_view_adopt_sort (
+  qtable_view_t *                       pTable
+) {
+  qtable_sort_t * pSort;
+
+  pSort = QP(pTable)->pSort;
+  if (!pSort || !atomic_load_explicit(&pSort->finished, memory_order_acquire)) {
+    return 0;
+  }
+  pthread_join(pSort->worker, NULL);
+  qtable_view_drop_order(pTable);
+  QP(pTable)->pOrder = pSort->pOrder;
+  QP(pTable)->sortColumn = pSort->column;
+  pSort->pOrder = NULL;
+  qtable_sort_free(QW(pTable)->pAllocator, pSort);
+  QP(pTable)->pSort = NULL;
+  qwidget_end_background();
+
+  qtable_view_repaint_all(pTable);
+  return qwidget_emit(pTable, sorted, QP(pTable)->sortColumn);
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t qtable_view_model_row (
+  qtable_view_t const *                 pTable,
+  uint64_t                              viewRow
+) {
+  return QP(pTable)->pOrder ? QP(pTable)->pOrder[viewRow] : viewRow;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t qtable_view_max_row (
+  qtable_view_t const *                 pTable
+) {
+  qextent_t rows;
+  rows = QW(pTable)->outerRegion.bounds.rows;
+  if (QP(pTable)->rowCount <= rows) {
+    return 0;
+  }
+  return QP(pTable)->rowCount - rows;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t qtable_view_max_column (
+  qtable_view_t const *                 pTable
+) {
+  return QP(pTable)->columnCount ? QP(pTable)->columnCount - 1 : 0;
+}
+
+// Measures the column from a sample of rows, rather than reading every row.
+//------------------------------------------------------------------------------
+static int qtable_view_column_width (
+  qtable_view_t *                       pTable,
+  uint32_t                              column,
+  qextent_t *                           pWidth
+) {
+  int err;
+  uint64_t sample;
+  uint64_t samples;
+  size_t length;
+  size_t widest;
+  char const * pText;
+
+  if (QP(pTable)->widths.pData[column]) {
+    *pWidth = QP(pTable)->widths.pData[column];
+    return 0;
+  }
+
+  widest = 1;
+  samples = QMIN(QP(pTable)->rowCount, QTABLE_SAMPLE_ROWS);
+  for (sample = 0; sample < samples; ++sample) {
+    err = qmodel_data(
+      QP(pTable)->pModel,
+      sample * (QP(pTable)->rowCount / samples),
+      column,
+      &pText,
+      &length
+    );
+    if (err) {
+      return err;
+    }
+    widest = QMAX(widest, length);
+  }
+
+  QP(pTable)->widths.pData[column] = (qextent_t)QMIN(widest, QTABLE_MAX_WIDTH);
+  *pWidth = QP(pTable)->widths.pData[column];
+  return 0;
+}
+
+// Reads the model's shape again, and forgets everything derived from the rows.
+//------------------------------------------------------------------------------
+static int qtable_view_reset (
+  qtable_view_t *                       pTable
+) {
+  int err;
+
+  qtable_view_cancel_sort(pTable);
+  qtable_view_drop_order(pTable);
+
+  QP(pTable)->rowCount = 0;
+  QP(pTable)->columnCount = 0;
+  qarray_clear(&QP(pTable)->widths);
+  if (QP(pTable)->pModel) {
+    QP(pTable)->rowCount = qmodel_row_count(QP(pTable)->pModel);
+    QP(pTable)->columnCount = qmodel_column_count(QP(pTable)->pModel);
+  }
+  if (QP(pTable)->widths.capacity < QP(pTable)->columnCount) {
+    err = qarray_resize(QW(pTable)->pAllocator, &QP(pTable)->widths, QP(pTable)->columnCount);
+    if (err) {
+      QP(pTable)->columnCount = 0;
+      return err;
+    }
+  }
+  if (QP(pTable)->columnCount) {
+    memset(QP(pTable)->widths.pData, 0, sizeof(qextent_t) * QP(pTable)->columnCount);
+  }
+  QP(pTable)->widths.count = QP(pTable)->columnCount;
+
+  QP(pTable)->rowOffset = QMIN(QP(pTable)->rowOffset, qtable_view_max_row(pTable));
+  QP(pTable)->columnOffset = QMIN(QP(pTable)->columnOffset, qtable_view_max_column(pTable));
+  qtable_view_repaint_all(pTable);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QRECALC(
+  qtable_view_recalculate,
+  qtable_view_t *                       pTable,
+  qregion_t const *                     pRegion
+) {
+  int err;
+
+  err = qtable_view_adopt_sort(pTable);
+  if (err) {
+    return err;
+  }
+  if (qregion_equal(&QW(pTable)->outerRegion, pRegion)) {
+    return 0;
+  }
+
+  // The stale rows are tracked per visible row, so there's one flag for each.
+  if (QP(pTable)->staleRows.capacity < pRegion->bounds.rows) {
+    err = qarray_resize(QW(pTable)->pAllocator, &QP(pTable)->staleRows, pRegion->bounds.rows);
+    if (err) {
+      return err;
+    }
+  }
+  if (pRegion->bounds.rows) {
+    memset(QP(pTable)->staleRows.pData, 0, sizeof(qbool_t) * pRegion->bounds.rows);
+  }
+  QP(pTable)->staleRows.count = pRegion->bounds.rows;
+
+  qtable_view_repaint_all(pTable);
+  QW(pTable)->contentBounds = pRegion->bounds;
+  QW(pTable)->outerRegion = *pRegion;
+  QW(pTable)->innerRegion = *pRegion;
+  QP(pTable)->rowOffset = QMIN(QP(pTable)->rowOffset, qtable_view_max_row(pTable));
+  return 0;
+}
+
+// Only the visible cells are read, columns are separated by a single space.
+// Note: Unless everything must be painted, only the cells of stale rows are read again.
+//------------------------------------------------------------------------------
+QPAINTER(
+  qtable_view_paint,
+  qtable_view_t *                       pTable,
+  qpainter_t *                          pPainter
+) {
+  int err;
+  uint32_t row;
+  uint32_t column;
+  uint64_t viewRow;
+  qextent_t width;
+  qextent_t x;
+  size_t length;
+  char const * pText;
+  qbool_t repaintAll;
+  qcoord_t printCoord;
+  qregion_t lineRegion;
+  qregion_t const * pRegion;
+
+  if (!qwidget_is_dirty(pTable)) {
+    return 0;
+  }
+  err = qtable_view_adopt_sort(pTable);
+  if (err) {
+    return err;
+  }
+
+  pRegion = &QW(pTable)->outerRegion;
+  repaintAll = QP(pTable)->repaintAll || qwidget_needs_repaint(pTable);
+  if (repaintAll) {
+    err = qpainter_clear(pPainter, pRegion);
+    if (err) {
+      return err;
+    }
+    QP(pTable)->columnEnd = QP(pTable)->columnOffset;
+  }
+
+  for (row = 0; row < pRegion->bounds.rows; ++row) {
+    viewRow = QP(pTable)->rowOffset + row;
+    if (viewRow >= QP(pTable)->rowCount) {
+      break;
+    }
+    if (!repaintAll) {
+      if (!QP(pTable)->staleRows.pData[row]) {
+        continue;
+      }
+      lineRegion = qregion(pRegion->coord.column, pRegion->coord.row + (qoffset_t)row, 1, pRegion->bounds.columns);
+      err = qpainter_clear(pPainter, &lineRegion);
+      if (err) {
+        return err;
+      }
+    }
+    QP(pTable)->staleRows.pData[row] = QFALSE;
+    x = 0;
+    for (column = QP(pTable)->columnOffset; column < QP(pTable)->columnCount && x < pRegion->bounds.columns; ++column) {
+      err = qtable_view_column_width(pTable, column, &width);
+      if (err) {
+        return err;
+      }
+      err = qmodel_data(
+        QP(pTable)->pModel,
+        qtable_view_model_row(pTable, viewRow),
+        column,
+        &pText,
+        &length
+      );
+      if (err) {
+        return err;
+      }
+
+      printCoord = qcoord(pRegion->coord.column + (qoffset_t)x, pRegion->coord.row + (qoffset_t)row);
+      err = qpainter_paint(
+        pPainter,
+        &printCoord,
+        pText,
+        QMIN(length, (size_t)QMIN(width, pRegion->bounds.columns - x))
+      );
+      if (err) {
+        return err;
+      }
+      x += QMIN(width, pRegion->bounds.columns - x);
+      x += (x < pRegion->bounds.columns) ? 1 : 0;
+    }
+    QP(pTable)->columnEnd = column;
+  }
+
+  QP(pTable)->repaintAll = QFALSE;
+  qwidget_unmark_dirty(pTable);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qtable_view_rows_changed,
+  qtable_view_t *                       pTable,
+  uint64_t                              first,
+  uint64_t                              count
+) {
+  uint64_t previousRow;
+
+  // The order no longer covers the rows, so the model order is shown until sorted again.
+  // The widths were sampled from the old rows, so they're measured again when next shown.
+  (void)first;
+  (void)count;
+  previousRow = QP(pTable)->rowOffset;
+  qtable_view_cancel_sort(pTable);
+  qtable_view_drop_order(pTable);
+  if (QP(pTable)->widths.count) {
+    memset(QP(pTable)->widths.pData, 0, sizeof(qextent_t) * QP(pTable)->widths.count);
+  }
+  QP(pTable)->rowCount = qmodel_row_count(QP(pTable)->pModel);
+  QP(pTable)->rowOffset = QMIN(QP(pTable)->rowOffset, qtable_view_max_row(pTable));
+  qtable_view_repaint_all(pTable);
+
+  if (QP(pTable)->rowOffset != previousRow) {
+    return qwidget_emit(pTable, scrolled, QP(pTable)->rowOffset, QP(pTable)->columnOffset);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qtable_view_data_changed,
+  qtable_view_t *                       pTable,
+  qmodel_range_t                        range
+) {
+  uint32_t row;
+  uint64_t modelRow;
+  uint64_t viewRows;
+
+  // Changes to columns outside of the view, or to rows not shown, don't need a repaint.
+  // Note: The painted columns only match the offset once painted, until then everything is painted anyway.
+  if (QP(pTable)->repaintAll) {
+    return 0;
+  }
+  if (range.columnCount <= UINT32_MAX - range.firstColumn &&
+      range.firstColumn + range.columnCount <= QP(pTable)->columnOffset) {
+    return 0;
+  }
+  if (range.firstColumn >= QP(pTable)->columnEnd) {
+    return 0;
+  }
+  viewRows = QMIN(QP(pTable)->staleRows.count, QP(pTable)->rowCount - QP(pTable)->rowOffset);
+  for (row = 0; row < viewRows; ++row) {
+    modelRow = qtable_view_model_row(pTable, QP(pTable)->rowOffset + row);
+    if (modelRow >= range.firstRow && modelRow - range.firstRow < range.rowCount) {
+      QP(pTable)->staleRows.pData[row] = QTRUE;
+      qwidget_mark_dirty(pTable);
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT_VOID(
+  qtable_view_model_reset,
+  qtable_view_t *                       pTable
+) {
+  return qtable_view_reset(pTable);
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qtable_view_key_press,
+  qtable_view_t *                       pTable,
+  qkey_event_t *                        pEvent
+) {
+  int64_t page;
+
+  page = QMAX(QW(pTable)->outerRegion.bounds.rows, 1);
+  switch (pEvent->code) {
+    case QKEY_UP:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, -1, 0);
+    case QKEY_DOWN:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, 1, 0);
+    case QKEY_LEFT:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, 0, -1);
+    case QKEY_RIGHT:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, 0, 1);
+    case QKEY_PAGE_UP:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, -page, 0);
+    case QKEY_PAGE_DOWN:
+      pEvent->accepted = QTRUE;
+      return qtable_view_scroll_by(pTable, page, 0);
+    case QKEY_HOME:
+      pEvent->accepted = QTRUE;
+      return qtable_view_set_scroll(pTable, 0, 0);
+    case QKEY_END:
+      pEvent->accepted = QTRUE;
+      return qtable_view_set_scroll(pTable, UINT64_MAX, QP(pTable)->columnOffset);
+    default:
+      return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Table View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_table_view (
+  qalloc_t const *                      pAllocator,
+  qtable_view_t **                      pTable
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qtable_view_t * table;
+
+  // Configure the table view as a widget.
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qtable_view_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qtable_view_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_table_view);
+  widgetConfig.pfnRecalculate = QRECALC_PTR(qtable_view_recalculate);
+  widgetConfig.pfnPaint       = QPAINTER_PTR(qtable_view_paint);
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = NULL;
+
+  // Allocate the table view.
+  err = qcreate_widget(
+    &widgetConfig,
+    &table
+  );
+  if (err) {
+    return err;
+  }
+
+  // Like the list, the table takes whatever space it can get.
+  QW(table)->sizePolicy = QPOLICY_EXPANDING;
+  QP(table)->repaintAll = QTRUE;
+  qwidget_set_focusable(table, QTRUE);
+  err = qwidget_connect(QW(table), on_key_press, table, qtable_view_key_press);
+  if (err) {
+    qdestroy_table_view(table);
+    return err;
+  }
+
+  // Return the table view to the caller.
+  *pTable = table;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_table_view (
+  qtable_view_t *                       pTable
+) {
+  qalloc_t const * pAllocator;
+  pAllocator = QW(pTable)->pAllocator;
+  qtable_view_cancel_sort(pTable);
+  qwidget_drop_posted_updates(pTable);
+  if (QP(pTable)->pModel) {
+    qwidget_disconnect(QP(pTable)->pModel, pTable);
+  }
+  qtable_view_drop_order(pTable);
+  qarray_deinit(pAllocator, &QP(pTable)->widths);
+  qarray_deinit(pAllocator, &QP(pTable)->staleRows);
+  qfree(pAllocator, pTable);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_set_model (
+  qtable_view_t *                       pTable,
+  qmodel_t *                            pModel
+) {
+  int err;
+
+  if (QP(pTable)->pModel) {
+    qwidget_disconnect(QP(pTable)->pModel, pTable);
+    QP(pTable)->pModel = NULL;
+  }
+
+  if (pModel) {
+    if (
+      (err = qwidget_connect(pModel, rows_inserted, pTable, qtable_view_rows_changed)) ||
+      (err = qwidget_connect(pModel, rows_removed, pTable, qtable_view_rows_changed)) ||
+      (err = qwidget_connect(pModel, data_changed, pTable, qtable_view_data_changed)) ||
+      (err = qwidget_connect(pModel, reset, pTable, qtable_view_model_reset))
+    ) {
+      qwidget_disconnect(pModel, pTable);
+      (void)qtable_view_reset(pTable);
+      return err;
+    }
+    QP(pTable)->pModel = pModel;
+  }
+
+  return qtable_view_reset(pTable);
+}
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtable_view_get_row (
+  qtable_view_t const *                 pTable
+) {
+  return QP(pTable)->rowOffset;
+}
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qtable_view_get_column (
+  qtable_view_t const *                 pTable
+) {
+  return QP(pTable)->columnOffset;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_set_scroll (
+  qtable_view_t *                       pTable,
+  uint64_t                              row,
+  uint32_t                              column
+) {
+  row = QMIN(row, qtable_view_max_row(pTable));
+  column = QMIN(column, qtable_view_max_column(pTable));
+  if (row == QP(pTable)->rowOffset && column == QP(pTable)->columnOffset) {
+    return 0;
+  }
+
+  QP(pTable)->rowOffset = row;
+  QP(pTable)->columnOffset = column;
+  qtable_view_repaint_all(pTable);
+  return qwidget_emit(pTable, scrolled, row, column);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_scroll_by (
+  qtable_view_t *                       pTable,
+  int64_t                               rows,
+  int32_t                               columns
+) {
+  uint64_t row;
+  int64_t column;
+
+  if (rows < 0) {
+    row = (uint64_t)-(rows + 1) + 1;
+    row = row > QP(pTable)->rowOffset ? 0 : QP(pTable)->rowOffset - row;
+  }
+  else {
+    row = QP(pTable)->rowOffset + (uint64_t)rows;
+    row = row < QP(pTable)->rowOffset ? UINT64_MAX : row;
+  }
+  column = QMAX((int64_t)QP(pTable)->columnOffset + columns, 0);
+  column = QMIN(column, (int64_t)UINT32_MAX);
+
+  return qtable_view_set_scroll(pTable, row, (uint32_t)column);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_sort (
+  qtable_view_t *                       pTable,
+  uint32_t                              column,
+  qbool_t                               descending,
+  qtable_compare_pfn                    pfnCompare,
+  void *                                pUserData
+) {
+  int err;
+  qtable_sort_t * pSort;
+  qalloc_t const * pAllocator;
+
+  if (!pfnCompare || column >= QP(pTable)->columnCount) {
+    return EINVAL;
+  }
+  if (QP(pTable)->rowCount > SIZE_MAX / sizeof(uint64_t)) {
+    return ERANGE;
+  }
+  qtable_view_cancel_sort(pTable);
+
+  // Note: Everything the worker needs is allocated here, so it never touches the allocator.
+  pAllocator = QW(pTable)->pAllocator;
+  pSort = qallocate(pAllocator, sizeof(qtable_sort_t), 1);
+  if (!pSort) {
+    return ENOMEM;
+  }
+  pSort->pTable     = pTable;
+  pSort->count      = QP(pTable)->rowCount;
+  pSort->column     = column;
+  pSort->descending = descending;
+  pSort->pfnCompare = pfnCompare;
+  pSort->pUserData  = pUserData;
+  pSort->pOrder     = qallocate(pAllocator, sizeof(uint64_t) * QMAX(pSort->count, 1), 1);
+  pSort->pScratch   = qallocate(pAllocator, sizeof(uint64_t) * QMAX(pSort->count, 1), 1);
+  atomic_init(&pSort->cancelled, QFALSE);
+  atomic_init(&pSort->finished, QFALSE);
+  if (!pSort->pOrder || !pSort->pScratch) {
+    qtable_sort_free(pAllocator, pSort);
+    return ENOMEM;
+  }
+
+  err = pthread_create(&pSort->worker, NULL, &qtable_sort_main, pSort);
+  if (err) {
+    qtable_sort_free(pAllocator, pSort);
+    return err;
+  }
+  QP(pTable)->pSort = pSort;
+  qwidget_begin_background();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL qtable_view_is_sorting (
+  qtable_view_t const *                 pTable
+) {
+  return QBOOL(QP(pTable)->pSort);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qtable_view_clear_sort (
+  qtable_view_t *                       pTable
+) {
+  qtable_view_cancel_sort(pTable);
+  if (QP(pTable)->pOrder) {
+    qtable_view_drop_order(pTable);
+    qtable_view_repaint_all(pTable);
+  }
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QTABLE_VIEW_H
+#define   QTABLE_VIEW_H
+
+#include "qcurses.h"
+#include "qmodel.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Table View Declarations
+////////////////////////////////////////////////////////////////////////////////
+
+// Compares two model rows by a column, returning <0, 0 or >0.
+// Note: This is called from a worker thread, it must not call into the model.
+typedef int (QCURSESPTR *qtable_compare_pfn)(void *, uint32_t, uint64_t, uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Table View Definition
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qtable_view_t)
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(scrolled, uint64_t row, uint32_t column);
+    QSIGNAL(sorted, uint32_t column);
+  QWIDGET_SIGNALS_END
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// Table View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_table_view (
+  qalloc_t const *                      pAllocator,
+  qtable_view_t **                      pTable
+);
+
+// Note: A sort which is still running is cancelled (and waited for).
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_table_view (
+  qtable_view_t *                       pTable
+);
+
+// Only the visible cells are ever read from the model, in both directions.
+// Note: Column widths are measured from a sample of rows, and measured again once rows are inserted or removed.
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_set_model (
+  qtable_view_t *                       pTable,
+  qmodel_t *                            pModel
+);
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtable_view_get_row (
+  qtable_view_t const *                 pTable
+);
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qtable_view_get_column (
+  qtable_view_t const *                 pTable
+);
+
+// Makes the cell the top-left visible cell (limited so that the last page stays full).
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_set_scroll (
+  qtable_view_t *                       pTable,
+  uint64_t                              row,
+  uint32_t                              column
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_scroll_by (
+  qtable_view_t *                       pTable,
+  int64_t                               rows,
+  int32_t                               columns
+);
+
+// Starts sorting the rows on a worker thread, the current order is shown until it's done.
+// When done the new order is swapped in at the next update, and 'sorted' is emitted.
+// Note: Inserting or removing model rows cancels the sort, and returns to the model order.
+//------------------------------------------------------------------------------
+int QCURSESCALL qtable_view_sort (
+  qtable_view_t *                       pTable,
+  uint32_t                              column,
+  qbool_t                               descending,
+  qtable_compare_pfn                    pfnCompare,
+  void *                                pUserData
+);
+
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL qtable_view_is_sorting (
+  qtable_view_t const *                 pTable
+);
+
+// Cancels any running sort, and shows the rows in the model order.
+//------------------------------------------------------------------------------
+void QCURSESCALL qtable_view_clear_sort (
+  qtable_view_t *                       pTable
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QTABLE_VIEW_H
@@ -0,0 +1,667 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "qtext_view.h"
+#include "qpainter.h"
+#include "qscan.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Text View Implementations
+////////////////////////////////////////////////////////////////////////////////
+
+// Offsets are kept in blocks, so that the index grows without moving what the UI thread reads.
+#define QTEXT_BLOCK_SHIFT               16
+#define QTEXT_BLOCK_OFFSETS             ((size_t)1 << QTEXT_BLOCK_SHIFT)
+
+// How much is indexed before the view is shown, and between publishing more lines.
+#define QTEXT_FIRST_BYTES               ((size_t)64 << 10)
+#define QTEXT_CHUNK_BYTES               ((size_t)4 << 20)
+
+// The offset of every line start followed by the offset just past the last line (as in qlabel_t).
+// The blocks are written by the worker, and read by the UI thread up to the published count.
+// Note: A line is at least one byte, so the block table is allocated for the worst case up front.
+//------------------------------------------------------------------------------
+typedef struct qtext_index_t {
+  qtext_view_t *                        pView;
+  qalloc_t const *                      pAllocator;
+  char const *                          pData;          // The mapped file.
+  size_t                                size;
+  size_t **                             ppBlocks;
+  size_t                                blockCapacity;
+  size_t                                written;        // Only touched by whoever is indexing.
+  qscan_t                               scan;
+  pthread_t                             worker;
+  qbool_t                               isRunning;      // The worker was started, and not joined.
+  int                                   result;
+  atomic_size_t                         count;          // How many offsets the UI thread may read.
+  atomic_bool                           cancelled;
+  atomic_bool                           finished;
+} qtext_index_t;
+
+//------------------------------------------------------------------------------
+struct QPIMPL_NAME(qtext_view_t) {
+  qtext_index_t *                       pIndex;         // NULL while no file is open.
+  uint64_t                              lineCount;      // The lines found, as of the last update.
+  uint64_t                              lineOffset;
+  uint64_t                              jumpLine;
+  qbool_t                               isJumping;      // Waiting for jumpLine to be found.
+  qbool_t                               repaintAll;
+  uint64_t                              paintedOffset;
+  qextent_t                             paintedRows;
+  qpainter_state_t                      paintedState;
+};
+
+//------------------------------------------------------------------------------
+QDEFINE_EMITTER(scrolled, uint64_t);
+QDEFINE_EMITTER(indexed, uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Text View Helpers
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+static inline size_t qtext_index_offset (
+  qtext_index_t const *                 pIndex,
+  uint64_t                              idx
+) {
+  return pIndex->ppBlocks[idx >> QTEXT_BLOCK_SHIFT][idx & (QTEXT_BLOCK_OFFSETS - 1)];
+}
+
+// Makes sure the block the next offset goes into exists, returns where it goes.
+//------------------------------------------------------------------------------
+static size_t * qtext_index_reserve (
+  qtext_index_t *                       pIndex
+) {
+  size_t block;
+
+  block = pIndex->written >> QTEXT_BLOCK_SHIFT;
+  if (block >= pIndex->blockCapacity) {
+    return NULL;
+  }
+  if (!pIndex->ppBlocks[block]) {
+    pIndex->ppBlocks[block] = qallocate(pIndex->pAllocator, QTEXT_BLOCK_OFFSETS * sizeof(size_t), sizeof(size_t));
+    if (!pIndex->ppBlocks[block]) {
+      return NULL;
+    }
+  }
+  return pIndex->ppBlocks[block] + (pIndex->written & (QTEXT_BLOCK_OFFSETS - 1));
+}
+
+// Finds the lines in the next end - scan.offset bytes, and publishes them to the UI thread.
+// Note: Lines are only published once their end is known, so a published line never changes.
+//------------------------------------------------------------------------------
+static int qtext_index_scan (
+  qtext_index_t *                       pIndex,
+  size_t                                end
+) {
+  size_t room;
+  size_t * pOffsets;
+
+  while (pIndex->scan.offset < end) {
+    pOffsets = qtext_index_reserve(pIndex);
+    if (!pOffsets) {
+      return ENOMEM;
+    }
+    room = QTEXT_BLOCK_OFFSETS - (pIndex->written & (QTEXT_BLOCK_OFFSETS - 1));
+    pIndex->written += qscan_lines(&pIndex->scan, pIndex->pData, end, pOffsets, room);
+  }
+
+  // The last line has no newline, so its end is only known once the whole file is scanned.
+  if (end == pIndex->size && pIndex->scan.lineStart < pIndex->size) {
+    pOffsets = qtext_index_reserve(pIndex);
+    if (!pOffsets) {
+      return ENOMEM;
+    }
+    *pOffsets = pIndex->size;
+    ++pIndex->written;
+  }
+
+  atomic_store_explicit(&pIndex->count, pIndex->written, memory_order_release);
+  return 0;
+}
+
+// Scans the file a chunk at a time, publishing the lines found after each.
+//------------------------------------------------------------------------------
+static void * qtext_index_main (
+  void *                                pData
+) {
+  qtext_index_t * pIndex;
+
+  pIndex = pData;
+  while (pIndex->scan.offset < pIndex->size) {
+    if (atomic_load_explicit(&pIndex->cancelled, memory_order_relaxed)) {
+      return NULL;
+    }
+    pIndex->result = qtext_index_scan(pIndex, QMIN(pIndex->size, pIndex->scan.offset + QTEXT_CHUNK_BYTES));
+    if (pIndex->result) {
+      break;
+    }
+    (void)qwidget_post_update(pIndex->pView);
+  }
+
+  atomic_store_explicit(&pIndex->finished, QTRUE, memory_order_release);
+  (void)qwidget_post_update(pIndex->pView);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void qtext_index_free (
+  qtext_index_t *                       pIndex
+) {
+  size_t idx;
+
+  if (pIndex->ppBlocks) {
+    for (idx = 0; idx < pIndex->blockCapacity && pIndex->ppBlocks[idx]; ++idx) {
+      qfree(pIndex->pAllocator, pIndex->ppBlocks[idx]);
+    }
+    qfree(pIndex->pAllocator, pIndex->ppBlocks);
+  }
+  if (pIndex->size) {
+    munmap((void *)pIndex->pData, pIndex->size);
+  }
+  qfree(pIndex->pAllocator, pIndex);
+}
+
+// Stops the worker (if any), and forgets the file.
+//------------------------------------------------------------------------------
+static void qtext_view_drop_index (
+  qtext_view_t *                        pView
+) {
+  qtext_index_t * pIndex;
+
+  pIndex = QP(pView)->pIndex;
+  if (!pIndex) {
+    return;
+  }
+  if (pIndex->isRunning) {
+    atomic_store_explicit(&pIndex->cancelled, QTRUE, memory_order_relaxed);
+    pthread_join(pIndex->worker, NULL);
+    qwidget_end_background();
+  }
+  qtext_index_free(pIndex);
+
+  QP(pView)->pIndex = NULL;
+  QP(pView)->lineCount = 0;
+  QP(pView)->lineOffset = 0;
+  QP(pView)->isJumping = QFALSE;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t qtext_view_max_line (
+  qtext_view_t const *                  pView
+) {
+  qextent_t rows;
+  rows = QW(pView)->outerRegion.bounds.rows;
+  if (QP(pView)->lineCount <= rows) {
+    return 0;
+  }
+  return QP(pView)->lineCount - rows;
+}
+
+//------------------------------------------------------------------------------
+static int qtext_view_scroll_to (
+  qtext_view_t *                        pView,
+  uint64_t                              line
+) {
+  line = QMIN(line, qtext_view_max_line(pView));
+  if (line == QP(pView)->lineOffset) {
+    return 0;
+  }
+
+  QP(pView)->lineOffset = line;
+  QP(pView)->repaintAll = QTRUE;
+  qwidget_mark_dirty(pView);
+  return qwidget_emit(pView, scrolled, line);
+}
+
+// A jump waits until the line can be the first line of a full page, or there are no more lines.
+//------------------------------------------------------------------------------
+static int qtext_view_try_jump (
+  qtext_view_t *                        pView
+) {
+  if (!QP(pView)->isJumping) {
+    return 0;
+  }
+  if (
+    QP(pView)->jumpLine > qtext_view_max_line(pView) &&
+    QP(pView)->pIndex && QP(pView)->pIndex->isRunning
+  ) {
+    return 0;
+  }
+  QP(pView)->isJumping = QFALSE;
+  return qtext_view_scroll_to(pView, QP(pView)->jumpLine);
+}
+
+// Picks up the lines published by the worker, and the worker itself once it's done (UI thread).
+//------------------------------------------------------------------------------
+static int qtext_view_adopt_index (
+  qtext_view_t *                        pView
+) {
+  int err;
+  qbool_t finished;
+  uint64_t lineCount;
+  qtext_index_t * pIndex;
+
+  pIndex = QP(pView)->pIndex;
+  if (!pIndex || !pIndex->isRunning) {
+    return 0;
+  }
+
+  // Note: The count is read after finished, so that it includes the last lines.
+  finished = atomic_load_explicit(&pIndex->finished, memory_order_acquire);
+  lineCount = atomic_load_explicit(&pIndex->count, memory_order_acquire) - 1;
+  if (lineCount != QP(pView)->lineCount) {
+    QP(pView)->lineCount = lineCount;
+    qwidget_mark_dirty(pView);
+  }
+  if (!finished) {
+    return qtext_view_try_jump(pView);
+  }
+
+  pthread_join(pIndex->worker, NULL);
+  pIndex->isRunning = QFALSE;
+  qwidget_end_background();
+  if (pIndex->result) {
+    return pIndex->result;
+  }
+
+  err = qtext_view_try_jump(pView);
+  if (err) {
+    return err;
+  }
+  return qwidget_emit(pView, indexed, QP(pView)->lineCount);
+}
+
+//------------------------------------------------------------------------------
+QRECALC(
+  qtext_view_recalculate,
+  qtext_view_t *                        pView,
+  qregion_t const *                     pRegion
+) {
+  int err;
+
+  err = qtext_view_adopt_index(pView);
+  if (err) {
+    return err;
+  }
+  if (qregion_equal(&QW(pView)->outerRegion, pRegion)) {
+    return 0;
+  }
+
+  qwidget_mark_state(pView, QSTATE_DIRTY_BIT);
+  QW(pView)->contentBounds = pRegion->bounds;
+  QW(pView)->outerRegion = *pRegion;
+  QW(pView)->innerRegion = *pRegion;
+  QP(pView)->lineOffset = QMIN(QP(pView)->lineOffset, qtext_view_max_line(pView));
+  QP(pView)->repaintAll = QTRUE;
+  return qtext_view_try_jump(pView);
+}
+
+// Lines found while the page was not yet full are painted below what was painted before.
+//------------------------------------------------------------------------------
+QPAINTER(
+  qtext_view_paint,
+  qtext_view_t *                        pView,
+  qpainter_t *                          pPainter
+) {
+  int err;
+  qextent_t row;
+  qextent_t rowCount;
+  uint64_t line;
+  size_t start;
+  size_t end;
+  qcoord_t printCoord;
+  qpainter_state_t paintedState;
+  qtext_index_t * pIndex;
+
+  if (!qwidget_is_dirty(pView)) {
+    return 0;
+  }
+  err = qtext_view_adopt_index(pView);
+  if (err) {
+    return err;
+  }
+
+  pIndex = QP(pView)->pIndex;
+  rowCount = (qextent_t)QMIN(
+    (uint64_t)QW(pView)->outerRegion.bounds.rows,
+    QP(pView)->lineCount - QMIN(QP(pView)->lineOffset, QP(pView)->lineCount)
+  );
+
+  // Note: The painter state differs when painting through a different window (e.g. when scrolled).
+  qpainter_save(pPainter, &paintedState);
+  row = 0;
+  if (
+    !QP(pView)->repaintAll && !qwidget_needs_repaint(pView) && QP(pView)->lineOffset == QP(pView)->paintedOffset &&
+    qcoord_equal(&paintedState.origin, &QP(pView)->paintedState.origin) &&
+    qregion_equal(&paintedState.clip, &QP(pView)->paintedState.clip)
+  ) {
+    row = QMIN(QP(pView)->paintedRows, rowCount);
+  }
+  else {
+    err = qpainter_clear(pPainter, &QW(pView)->outerRegion);
+    if (err) {
+      return err;
+    }
+  }
+
+  // Only the visible lines are ever read, so the rest of the file is never paged in by painting.
+  for (; row < rowCount; ++row) {
+    line = QP(pView)->lineOffset + row;
+    start = qtext_index_offset(pIndex, line);
+    end = qtext_index_offset(pIndex, line + 1);
+    if (end > start && pIndex->pData[end - 1] == '\n') {
+      --end;
+    }
+    printCoord = qcoord(
+      QW(pView)->outerRegion.coord.column,
+      QW(pView)->outerRegion.coord.row + (qoffset_t)row
+    );
+    err = qpainter_paint(
+      pPainter,
+      &printCoord,
+      pIndex->pData + start,
+      QMIN(end - start, (size_t)QW(pView)->outerRegion.bounds.columns)
+    );
+    if (err) {
+      return err;
+    }
+  }
+
+  QP(pView)->repaintAll = QFALSE;
+  QP(pView)->paintedOffset = QP(pView)->lineOffset;
+  QP(pView)->paintedRows = rowCount;
+  QP(pView)->paintedState = paintedState;
+  qwidget_unmark_dirty(pView);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+QSLOT(
+  qtext_view_key_press,
+  qtext_view_t *                        pView,
+  qkey_event_t *                        pEvent
+) {
+  int64_t page;
+
+  page = QMAX(QW(pView)->outerRegion.bounds.rows, 1);
+  switch (pEvent->code) {
+    case QKEY_UP:
+      pEvent->accepted = QTRUE;
+      return qtext_view_scroll_by(pView, -1);
+    case QKEY_DOWN:
+      pEvent->accepted = QTRUE;
+      return qtext_view_scroll_by(pView, 1);
+    case QKEY_PAGE_UP:
+      pEvent->accepted = QTRUE;
+      return qtext_view_scroll_by(pView, -page);
+    case QKEY_PAGE_DOWN:
+      pEvent->accepted = QTRUE;
+      return qtext_view_scroll_by(pView, page);
+    case QKEY_HOME:
+      pEvent->accepted = QTRUE;
+      return qtext_view_set_scroll(pView, 0);
+    case QKEY_END:
+      pEvent->accepted = QTRUE;
+      return qtext_view_jump_to_line(pView, UINT64_MAX);
+    default:
+      return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Text View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_text_view (
+  qalloc_t const *                      pAllocator,
+  qtext_view_t **                       pView
+) {
+  int err;
+  qwidget_config_t widgetConfig;
+  qtext_view_t * view;
+
+  // Configure the text view as a widget.
+  widgetConfig.pAllocator     = pAllocator;
+  widgetConfig.publicSize     = sizeof(qtext_view_t);
+  widgetConfig.privateSize    = sizeof(QPIMPL_STRUCT(qtext_view_t));
+  widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_text_view);
+  widgetConfig.pfnRecalculate = QRECALC_PTR(qtext_view_recalculate);
+  widgetConfig.pfnPaint       = QPAINTER_PTR(qtext_view_paint);
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = NULL;
+
+  // Allocate the text view.
+  err = qcreate_widget(
+    &widgetConfig,
+    &view
+  );
+  if (err) {
+    return err;
+  }
+
+  // Like the list, the text view takes whatever space it can get.
+  QW(view)->sizePolicy = QPOLICY_EXPANDING;
+  QP(view)->repaintAll = QTRUE;
+  qwidget_set_focusable(view, QTRUE);
+  err = qwidget_connect(QW(view), on_key_press, view, qtext_view_key_press);
+  if (err) {
+    qdestroy_text_view(view);
+    return err;
+  }
+
+  // Return the text view to the caller.
+  *pView = view;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_text_view (
+  qtext_view_t *                        pView
+) {
+  qtext_view_drop_index(pView);
+  qwidget_drop_posted_updates(pView);
+  qfree(QW(pView)->pAllocator, pView);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_open (
+  qtext_view_t *                        pView,
+  char const *                          path
+) {
+  int err;
+  int fd;
+  struct stat info;
+  qtext_index_t * pIndex;
+  size_t * pOffsets;
+
+  qtext_view_close(pView);
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return errno;
+  }
+  if (fstat(fd, &info) != 0) {
+    err = errno;
+    close(fd);
+    return err;
+  }
+  if ((uint64_t)info.st_size >= SIZE_MAX) {
+    close(fd);
+    return EFBIG;
+  }
+
+  pIndex = qallocate(QW(pView)->pAllocator, sizeof(qtext_index_t), 1);
+  if (!pIndex) {
+    close(fd);
+    return ENOMEM;
+  }
+  memset(pIndex, 0, sizeof(qtext_index_t));
+  pIndex->pView = pView;
+  pIndex->pAllocator = QW(pView)->pAllocator;
+  atomic_init(&pIndex->count, 0);
+  atomic_init(&pIndex->cancelled, QFALSE);
+  atomic_init(&pIndex->finished, QFALSE);
+
+  // Note: An empty file cannot be mapped, though it has nothing to show anyway.
+  pIndex->size = (size_t)info.st_size;
+  if (pIndex->size) {
+    pIndex->pData = mmap(NULL, pIndex->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pIndex->pData == MAP_FAILED) {
+      err = errno;
+      pIndex->size = 0;
+      close(fd);
+      qtext_index_free(pIndex);
+      return err;
+    }
+  }
+  close(fd);
+
+  // The first line starts at 0, and every line after starts where one ends.
+  pIndex->blockCapacity = (pIndex->size + 1) / QTEXT_BLOCK_OFFSETS + 1;
+  pIndex->ppBlocks = qallocate(pIndex->pAllocator, pIndex->blockCapacity * sizeof(size_t *), sizeof(size_t *));
+  if (!pIndex->ppBlocks) {
+    qtext_index_free(pIndex);
+    return ENOMEM;
+  }
+  memset(pIndex->ppBlocks, 0, pIndex->blockCapacity * sizeof(size_t *));
+  pOffsets = qtext_index_reserve(pIndex);
+  if (!pOffsets) {
+    qtext_index_free(pIndex);
+    return ENOMEM;
+  }
+  *pOffsets = 0;
+  pIndex->written = 1;
+  qscan_init(&pIndex->scan, 0);
+
+  // Index the start of the file here, so that the first screen is shown without waiting.
+  err = qtext_index_scan(pIndex, QMIN(pIndex->size, QTEXT_FIRST_BYTES));
+  if (err) {
+    qtext_index_free(pIndex);
+    return err;
+  }
+
+  // Note: From here on the worker owns the scan, only what it publishes may be read.
+  QP(pView)->lineCount = pIndex->written - 1;
+  if (pIndex->scan.offset < pIndex->size) {
+    err = pthread_create(&pIndex->worker, NULL, &qtext_index_main, pIndex);
+    if (err) {
+      QP(pView)->lineCount = 0;
+      qtext_index_free(pIndex);
+      return err;
+    }
+    pIndex->isRunning = QTRUE;
+    qwidget_begin_background();
+  }
+
+  QP(pView)->pIndex = pIndex;
+  QP(pView)->lineOffset = 0;
+  QP(pView)->isJumping = QFALSE;
+  QP(pView)->repaintAll = QTRUE;
+  qwidget_mark_dirty(pView);
+
+  if (!pIndex->isRunning) {
+    return qwidget_emit(pView, indexed, QP(pView)->lineCount);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qtext_view_close (
+  qtext_view_t *                        pView
+) {
+  if (!QP(pView)->pIndex) {
+    return;
+  }
+  qtext_view_drop_index(pView);
+  QP(pView)->repaintAll = QTRUE;
+  qwidget_mark_dirty(pView);
+}
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtext_view_line_count (
+  qtext_view_t const *                  pView
+) {
+  return QP(pView)->lineCount;
+}
+
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL qtext_view_is_indexing (
+  qtext_view_t const *                  pView
+) {
+  return QBOOL(QP(pView)->pIndex && QP(pView)->pIndex->isRunning);
+}
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtext_view_get_scroll (
+  qtext_view_t const *                  pView
+) {
+  return QP(pView)->lineOffset;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_set_scroll (
+  qtext_view_t *                        pView,
+  uint64_t                              line
+) {
+  QP(pView)->isJumping = QFALSE;
+  return qtext_view_scroll_to(pView, line);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_scroll_by (
+  qtext_view_t *                        pView,
+  int64_t                               delta
+) {
+  uint64_t line;
+
+  if (delta < 0) {
+    line = (uint64_t)-(delta + 1) + 1;
+    line = line > QP(pView)->lineOffset ? 0 : QP(pView)->lineOffset - line;
+  }
+  else {
+    line = QP(pView)->lineOffset + (uint64_t)delta;
+    line = line < QP(pView)->lineOffset ? UINT64_MAX : line;
+  }
+
+  return qtext_view_set_scroll(pView, line);
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_jump_to_line (
+  qtext_view_t *                        pView,
+  uint64_t                              line
+) {
+  QP(pView)->jumpLine = line;
+  QP(pView)->isJumping = QTRUE;
+  return qtext_view_try_jump(pView);
+}
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Copyright 2017 Trent Reed
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifndef   QTEXT_VIEW_H
+#define   QTEXT_VIEW_H
+
+#include "qcurses.h"
+#include "qwidget.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+////////////////////////////////////////////////////////////////////////////////
+// Text View Definition
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+QWIDGET_BEGIN(qtext_view_t)
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(scrolled, uint64_t line);
+    QSIGNAL(indexed, uint64_t lineCount);
+  QWIDGET_SIGNALS_END
+QWIDGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// Text View Functions
+////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qcreate_text_view (
+  qalloc_t const *                      pAllocator,
+  qtext_view_t **                       pView
+);
+
+// Note: Indexing which is still running is cancelled (and waited for).
+//------------------------------------------------------------------------------
+void QCURSESCALL qdestroy_text_view (
+  qtext_view_t *                        pView
+);
+
+// Maps the file into memory, the first lines are found at once so the first screen shows immediately.
+// The rest of the lines are found on a worker thread, and become visible as they are found.
+// When all of them are found 'indexed' is emitted (at the next update).
+// Note: The file is read in place, it must not be truncated while open.
+//       The index grows from the worker thread, so the allocator must be thread-safe (the default one is).
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_open (
+  qtext_view_t *                        pView,
+  char const *                          path
+);
+
+// Cancels any indexing, and unmaps the file.
+//------------------------------------------------------------------------------
+void QCURSESCALL qtext_view_close (
+  qtext_view_t *                        pView
+);
+
+// The lines found so far, which is every line once indexing is done.
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtext_view_line_count (
+  qtext_view_t const *                  pView
+);
+
+//------------------------------------------------------------------------------
+qbool_t QCURSESCALL qtext_view_is_indexing (
+  qtext_view_t const *                  pView
+);
+
+//------------------------------------------------------------------------------
+uint64_t QCURSESCALL qtext_view_get_scroll (
+  qtext_view_t const *                  pView
+);
+
+// Makes the line the first visible line (limited so that the last page of the lines found stays full).
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_set_scroll (
+  qtext_view_t *                        pView,
+  uint64_t                              line
+);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_scroll_by (
+  qtext_view_t *                        pView,
+  int64_t                               delta
+);
+
+// Like qtext_view_set_scroll(), but a line which was not found yet is jumped to once it is.
+// Note: UINT64_MAX jumps to the end, once indexing is done. Scrolling meanwhile cancels the jump.
+//------------------------------------------------------------------------------
+int QCURSESCALL qtext_view_jump_to_line (
+  qtext_view_t *                        pView,
+  uint64_t                              line
+);
+
+#ifdef    __cplusplus
+}
+#endif // __cplusplus
+
+#endif // QTEXT_VIEW_H
@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include "qwidget.h"
+#include <pthread.h>
 #include <string.h>
 
 #ifdef    __cplusplus
@@ -31,6 +32,144 @@ typedef struct qwidget_pimpl_t {
   void *                              pImpl;
 } qwidget_pimpl_t;
 
+//------------------------------------------------------------------------------
+typedef struct qpending_signal_t {
+  qconnection_t *                     pConnection;    // NULL once delivered out-of-order.
+  qwidget_t *                         pScope;         // Open transaction holding the signal.
+  qsignal_invoke_pfn                  pfnInvoke;
+  uint32_t                            payloadOffset;
+  uint32_t                            payloadSize;
+} qpending_signal_t;
+
+// Note: Signals are not async, so a single queue is shared by all widgets.
+//       It is owned by the default allocator since it outlives any one widget.
+//------------------------------------------------------------------------------
+static struct {
+  QDEFINE_ARRAY(qpending_signal_t)    pending;
+  QDEFINE_ARRAY(char)                 payloads;
+} sSignalQueue;
+
+// The number of open update transactions, so emit only searches when needed.
+static uint32_t sActiveUpdates;
+
+// Bumped on structural changes, so that derived orderings know to rebuild.
+static uint32_t sTreeGeneration;
+
+// Updates posted by other threads, these are the only state shared across threads.
+// Note: Owned by the default allocator, the same as the signal queue.
+static pthread_mutex_t sPostedLock = PTHREAD_MUTEX_INITIALIZER;
+static qarray_widget_t sPostedUpdates;
+
+// Background work in flight (only touched by the UI thread).
+static uint32_t sBackgroundCount;
+
+// Told about every widget destroyed, see qwidget_set_forget_hook().
+static qwidget_forget_pfn sForgetHook;
+static void * sForgetData;
+
+//------------------------------------------------------------------------------
+static int qsignal_queue_push (
+  qconnection_t *                     pConnection,
+  qwidget_t *                         pScope,
+  qsignal_invoke_pfn                  pfnInvoke,
+  void const *                        pPayload,
+  size_t                              payloadSize
+) {
+  int err;
+  qpending_signal_t pending;
+
+  // Reserve the payload storage first, so that a failure leaves nothing queued.
+  // Payloads are copied into one contiguous buffer to avoid an allocation per emit.
+  if (payloadSize > UINT32_MAX - sSignalQueue.payloads.count) {
+    return ERANGE;
+  }
+  while (sSignalQueue.payloads.capacity - sSignalQueue.payloads.count < payloadSize) {
+    err = qarray_grow(qdefault_allocator(), &sSignalQueue.payloads);
+    if (err) {
+      return err;
+    }
+  }
+  err = qarray_ensure(qdefault_allocator(), &sSignalQueue.pending);
+  if (err) {
+    return err;
+  }
+
+  // Record the payload and remember where the connection is pending.
+  pending.pConnection   = pConnection;
+  pending.pScope        = pScope;
+  pending.pfnInvoke     = pfnInvoke;
+  pending.payloadOffset = sSignalQueue.payloads.count;
+  pending.payloadSize   = (uint32_t)payloadSize;
+  if (payloadSize) {
+    memcpy(sSignalQueue.payloads.pData + pending.payloadOffset, pPayload, payloadSize);
+  }
+  sSignalQueue.payloads.count += (uint32_t)payloadSize;
+  (void)qarray_push(qdefault_allocator(), &sSignalQueue.pending, pending);
+  pConnection->pendingIndex = sSignalQueue.pending.count;
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int qsignal_queue_coalesce (
+  qconnection_t *                     pConnection,
+  qwidget_t *                         pScope,
+  qsignal_invoke_pfn                  pfnInvoke,
+  void const *                        pPayload,
+  size_t                              payloadSize
+) {
+
+  // If the connection is already pending, only the latest payload matters.
+  // Every emit of a signal has the same payload size, so overwrite in-place.
+  if (pConnection->pendingIndex) {
+    memcpy(
+      sSignalQueue.payloads.pData +
+      sSignalQueue.pending.pData[pConnection->pendingIndex - 1].payloadOffset,
+      pPayload,
+      payloadSize
+    );
+    return 0;
+  }
+
+  return qsignal_queue_push(pConnection, pScope, pfnInvoke, pPayload, payloadSize);
+}
+
+//------------------------------------------------------------------------------
+static qwidget_t * qwidget_find_update_scope (
+  qwidget_t *                         pWidget
+) {
+  qwidget_t * pScope;
+
+  // The outermost transaction wins, so that nested transactions flush only once.
+  pScope = NULL;
+  do {
+    if (qwidget_is_updating(pWidget)) {
+      pScope = pWidget;
+    }
+  } while ((pWidget = pWidget->pParent));
+
+  return pScope;
+}
+
+//------------------------------------------------------------------------------
+static void qwidget_propagate_dirty (
+  qwidget_t *                         pWidget
+) {
+
+  // Iteratively mark the parents recursive until we find a dirty parent.
+  // An open transaction holds the propagation until qwidget_end_update().
+  while ((pWidget = pWidget->pParent)) {
+    if (qwidget_check_state(pWidget, QSTATE_DIRTY_BIT)) {
+      break;
+    }
+    qwidget_mark_state(pWidget, QSTATE_DIRTY_BIT);
+    if (qwidget_is_updating(pWidget)) {
+      qwidget_mark_state(pWidget, QSTATE_DEFERRED_BIT);
+      break;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Widget Functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -70,10 +209,13 @@ int QCURSESCALL __qcreate_widget (
   widget->baseWidget.pfnDestroy       = pConfig->pfnDestroy;
   widget->baseWidget.pfnRecalculate   = pConfig->pfnRecalculate;
   widget->baseWidget.pfnPaint         = pConfig->pfnPaint;
+  widget->baseWidget.pfnVisit         = pConfig->pfnVisit;
+  widget->baseWidget.pfnMeasure       = pConfig->pfnMeasure;
+  widget->baseWidget.spatialEntry     = QSPATIAL_ENTRY_NONE;
   widget->baseWidget.minimumBounds    = qbounds(0, 0);
   widget->baseWidget.maximumBounds    = qbounds(QINFINITE, QINFINITE);
   widget->baseWidget.sizePolicy       = QPOLICY_PREFERRED;
-  widget->baseWidget.internalState    = QSTATE_DIRTY_BIT | QSTATE_ENABLED_BIT | QSTATE_VISIBLE_BIT;
+  widget->baseWidget.internalState    = QSTATE_DIRTY_BIT | QSTATE_ENABLED_BIT | QSTATE_VISIBLE_BIT | QSTATE_MEASURE_BIT;
   widget->pImpl = ((char *)widget) + pConfig->publicSize;
 
   *pResult = &widget->baseWidget;
@@ -84,14 +226,183 @@ int QCURSESCALL __qcreate_widget (
 void QCURSESCALL __qdestroy_widget (
   qwidget_t *                           pWidget
 ) {
+  uint32_t idx;
+  qpending_signal_t * pPending;
+
+  // Pending deliveries from or to the widget are left as tombstones, the same as a disconnect.
+  // Signals held by its transaction no longer have a scope, so they're delivered at the next flush.
+  for (idx = 0; idx < sSignalQueue.pending.count; ++idx) {
+    pPending = &sSignalQueue.pending.pData[idx];
+    if (pPending->pScope == pWidget) {
+      pPending->pScope = NULL;
+    }
+    if (!pPending->pConnection) {
+      continue;
+    }
+    if (pPending->pConnection->pSource == pWidget || pPending->pConnection->pTarget == pWidget) {
+      if (pPending->pConnection->pendingIndex == idx + 1) {
+        pPending->pConnection->pendingIndex = 0;
+      }
+      pPending->pConnection = NULL;
+    }
+  }
+  if (pWidget->updateDepth) {
+    --sActiveUpdates;
+  }
+
+  // Whatever refers to the widget by pointer has to let go before it is freed.
+  if (sForgetHook) {
+    sForgetHook(pWidget, sForgetData);
+  }
+  ++sTreeGeneration;
+
   pWidget->pfnDestroy(pWidget);
 }
 
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_focusable (
+  qwidget_t *                           pWidget,
+  qbool_t                               focusable
+) {
+  if (QBOOL(qwidget_is_focusable(pWidget)) == QBOOL(focusable)) {
+    return;
+  }
+  qwidget_set_state(pWidget, QSTATE_FOCUSABLE_BIT, focusable);
+  ++sTreeGeneration;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_visible (
+  qwidget_t *                           pWidget,
+  qbool_t                               visible
+) {
+  if (QBOOL(qwidget_is_visible(pWidget)) == QBOOL(visible)) {
+    return;
+  }
+  qwidget_set_state(pWidget, QSTATE_VISIBLE_BIT, visible);
+  ++sTreeGeneration;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_parent (
+  qwidget_t *                           pWidget,
+  qwidget_t *                           pParent
+) {
+
+  // Both the old and the new parent have to measure their children again.
+  if (pWidget->pParent) {
+    qwidget_update_geometry(pWidget->pParent);
+  }
+  pWidget->pParent = pParent;
+  if (pParent) {
+    qwidget_update_geometry(pParent);
+  }
+  ++sTreeGeneration;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_size_hint (
+  qwidget_t *                           pWidget,
+  qbounds_t *                           pHint
+) {
+  int err;
+  qbounds_t hint;
+
+  // Only measure again if the content (or the content of a child) has changed.
+  if (qwidget_check_state(pWidget, QSTATE_MEASURE_BIT)) {
+    hint = pWidget->minimumBounds;
+    if (pWidget->pfnMeasure) {
+      err = pWidget->pfnMeasure(pWidget, &hint);
+      if (err) {
+        return err;
+      }
+    }
+    pWidget->sizeHint = qbounds(
+      QMAX(QMIN(hint.rows, pWidget->maximumBounds.rows), pWidget->minimumBounds.rows),
+      QMAX(QMIN(hint.columns, pWidget->maximumBounds.columns), pWidget->minimumBounds.columns)
+    );
+    qwidget_unmark_state(pWidget, QSTATE_MEASURE_BIT);
+  }
+
+  *pHint = pWidget->sizeHint;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_update_geometry (
+  qwidget_t *                           pWidget
+) {
+  qwidget_t * pCurrent;
+
+  // A parent's hint depends on its children, so the invalidation travels to the root.
+  // Note: A stale widget always has stale ancestors, so we can stop at the first one.
+  pCurrent = pWidget;
+  while (pCurrent && !qwidget_check_state(pCurrent, QSTATE_MEASURE_BIT)) {
+    qwidget_mark_state(pCurrent, QSTATE_MEASURE_BIT);
+    pCurrent = pCurrent->pParent;
+  }
+
+  qwidget_mark_dirty(pWidget);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_size_policy (
+  qwidget_t *                           pWidget,
+  qpolicy_t                             policy
+) {
+  if (pWidget->sizePolicy != policy) {
+    pWidget->sizePolicy = policy;
+    qwidget_update_geometry(pWidget);
+  }
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_minimum_bounds (
+  qwidget_t *                           pWidget,
+  qbounds_t const *                     pBounds
+) {
+  if (!qbounds_equal(&pWidget->minimumBounds, pBounds)) {
+    pWidget->minimumBounds = *pBounds;
+    qwidget_update_geometry(pWidget);
+  }
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_maximum_bounds (
+  qwidget_t *                           pWidget,
+  qbounds_t const *                     pBounds
+) {
+  if (!qbounds_equal(&pWidget->maximumBounds, pBounds)) {
+    pWidget->maximumBounds = *pBounds;
+    qwidget_update_geometry(pWidget);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qwidget_tree_generation (void) {
+  return sTreeGeneration;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_bump_tree_generation (void) {
+  ++sTreeGeneration;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_set_forget_hook (
+  qwidget_forget_pfn                    pfnForget,
+  void *                                pUserData
+) {
+  sForgetHook = pfnForget;
+  sForgetData = pUserData;
+}
+
 //------------------------------------------------------------------------------
 int QCURSESCALL __qwidget_prepare_connection (
   qwidget_t *                           pSource,
   qwidget_t *                           pTarget,
-  qsignal_t *                           pSignal
+  qsignal_t *                           pSignal,
+  qdelivery_t                           delivery
 ) {
   int err;
   qconnection_t * pConnection;
@@ -120,6 +431,8 @@ int QCURSESCALL __qwidget_prepare_connection (
   pConnection->pSource = pSource;
   pConnection->pTarget = pTarget;
   pConnection->pSignal = pSignal;
+  pConnection->delivery = delivery;
+  pConnection->pendingIndex = 0;
   pConnection->pfnSlot = NULL;
 
   // Attach the connection to the signal/slot.
@@ -130,6 +443,298 @@ int QCURSESCALL __qwidget_prepare_connection (
   return 0;
 }
 
+//------------------------------------------------------------------------------
+static void qconnection_array_remove (
+  qarray_connection_t *               pArray,
+  qconnection_t *                     pConnection
+) {
+  uint32_t idx;
+  for (idx = 0; idx < pArray->count; ++idx) {
+    if (pArray->pData[idx] == pConnection) {
+      memmove(&pArray->pData[idx], &pArray->pData[idx + 1], sizeof(qconnection_t *) * (pArray->count - idx - 1));
+      --pArray->count;
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_disconnect (
+  qwidget_t *                           pSource,
+  qwidget_t *                           pTarget
+) {
+  uint32_t idx;
+  uint32_t pending;
+  qconnection_t * pConnection;
+
+  // Note: Iterate backwards, connections are removed from the array as we go.
+  idx = pTarget->connections.count;
+  while (idx--) {
+    pConnection = pTarget->connections.pData[idx];
+    if (pConnection->pSource != pSource) {
+      continue;
+    }
+
+    // Pending deliveries are left as tombstones, the same as out-of-order delivery.
+    // Note: Queued connections may be pending more than once, so search the whole queue.
+    for (pending = 0; pending < sSignalQueue.pending.count; ++pending) {
+      if (sSignalQueue.pending.pData[pending].pConnection == pConnection) {
+        sSignalQueue.pending.pData[pending].pConnection = NULL;
+      }
+    }
+    qconnection_array_remove((qarray_connection_t *)pConnection->pSignal, pConnection);
+    qconnection_array_remove(&pTarget->connections, pConnection);
+    qfree(pTarget->pAllocator, pConnection);
+  }
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_emit (
+  qwidget_t *                           pSource,
+  qsignal_t *                           pSignal,
+  void const *                          pPayload,
+  size_t                                payloadSize,
+  qsignal_invoke_pfn                    pfnInvoke
+) {
+  int err;
+  int result;
+  uint32_t idx;
+  qwidget_t * pScope;
+  qconnection_t * pConnection;
+
+  // Direct connections are held back while the source is within a transaction.
+  pScope = NULL;
+  if (sActiveUpdates) {
+    pScope = qwidget_find_update_scope(pSource);
+  }
+
+  // Note: The signal array is re-read each iteration, since a slot may connect to it.
+  result = 0;
+  for (idx = 0; idx < pSignal->count; ++idx) {
+    pConnection = (qconnection_t *)pSignal->pData[idx];
+    switch (pConnection->delivery) {
+      case QDELIVERY_DIRECT:
+        if (pScope) {
+          err = qsignal_queue_coalesce(pConnection, pScope, pfnInvoke, pPayload, payloadSize);
+        }
+        else {
+          err = pfnInvoke(pConnection, pPayload);
+        }
+        break;
+
+      case QDELIVERY_QUEUED:
+        err = qsignal_queue_push(pConnection, NULL, pfnInvoke, pPayload, payloadSize);
+        break;
+
+      case QDELIVERY_COALESCED:
+        err = qsignal_queue_coalesce(pConnection, NULL, pfnInvoke, pPayload, payloadSize);
+        break;
+
+      default:
+        err = EINVAL;
+        break;
+    }
+
+    // Keep delivering to the remaining slots, but report the first failure.
+    if (err && !result) {
+      result = err;
+    }
+  }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL qflush_signals (void) {
+  int err;
+  int result;
+  uint32_t idx;
+  uint32_t kept;
+  uint32_t keptSize;
+  qpending_signal_t pending;
+
+  // Slots may emit further signals while we flush, those are delivered in this pass too.
+  // The invoker copies the payload out before calling the slot, so growth is safe.
+  // Signals held by a still-open transaction are compacted to the front and kept, with their payloads.
+  // Note: Payloads are in queue order, so a kept payload only overwrites ones which were already handled.
+  result = 0;
+  kept = 0;
+  keptSize = 0;
+  for (idx = 0; idx < sSignalQueue.pending.count; ++idx) {
+    pending = sSignalQueue.pending.pData[idx];
+    if (!pending.pConnection) {
+      continue;
+    }
+    if (pending.pScope) {
+      if (pending.pConnection->pendingIndex == idx + 1) {
+        pending.pConnection->pendingIndex = kept + 1;
+      }
+      if (pending.payloadOffset != keptSize) {
+        memmove(
+          sSignalQueue.payloads.pData + keptSize,
+          sSignalQueue.payloads.pData + pending.payloadOffset,
+          pending.payloadSize
+        );
+        pending.payloadOffset = keptSize;
+      }
+      keptSize += pending.payloadSize;
+      sSignalQueue.pending.pData[kept++] = pending;
+      continue;
+    }
+    if (pending.pConnection->pendingIndex == idx + 1) {
+      pending.pConnection->pendingIndex = 0;
+    }
+    err = pending.pfnInvoke(
+      pending.pConnection,
+      sSignalQueue.payloads.pData + pending.payloadOffset
+    );
+    if (err && !result) {
+      result = err;
+    }
+  }
+
+  sSignalQueue.pending.count = kept;
+  sSignalQueue.payloads.count = keptSize;
+  return result;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qteardown_signals (void) {
+  uint32_t idx;
+
+  // Connections still point into the queue, so they have to forget it first.
+  for (idx = 0; idx < sSignalQueue.pending.count; ++idx) {
+    if (sSignalQueue.pending.pData[idx].pConnection) {
+      sSignalQueue.pending.pData[idx].pConnection->pendingIndex = 0;
+    }
+  }
+  qarray_deinit(qdefault_allocator(), &sSignalQueue.pending);
+  qarray_deinit(qdefault_allocator(), &sSignalQueue.payloads);
+  memset(&sSignalQueue, 0, sizeof(sSignalQueue));
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_post_update (
+  qwidget_t *                           pWidget
+) {
+  int err;
+  uint32_t idx;
+
+  pthread_mutex_lock(&sPostedLock);
+  for (idx = 0; idx < sPostedUpdates.count; ++idx) {
+    if (sPostedUpdates.pData[idx] == pWidget) {
+      pthread_mutex_unlock(&sPostedLock);
+      return 0;
+    }
+  }
+  err = qarray_push(qdefault_allocator(), &sPostedUpdates, pWidget);
+  pthread_mutex_unlock(&sPostedLock);
+  return err;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_drop_posted_updates (
+  qwidget_t *                           pWidget
+) {
+  uint32_t idx;
+
+  pthread_mutex_lock(&sPostedLock);
+  for (idx = 0; idx < sPostedUpdates.count; ++idx) {
+    if (sPostedUpdates.pData[idx] == pWidget) {
+      sPostedUpdates.pData[idx] = sPostedUpdates.pData[--sPostedUpdates.count];
+      break;
+    }
+  }
+  pthread_mutex_unlock(&sPostedLock);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qflush_posted_updates (void) {
+  uint32_t idx;
+
+  // Note: Marking dirty never posts, so it's safe to do while holding the lock.
+  pthread_mutex_lock(&sPostedLock);
+  for (idx = 0; idx < sPostedUpdates.count; ++idx) {
+    qwidget_mark_dirty(sPostedUpdates.pData[idx]);
+  }
+  qarray_clear(&sPostedUpdates);
+  pthread_mutex_unlock(&sPostedLock);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_begin_background (void) {
+  ++sBackgroundCount;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_end_background (void) {
+  --sBackgroundCount;
+}
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qwidget_background_count (void) {
+  return sBackgroundCount;
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_begin_update (
+  qwidget_t *                           pWidget
+) {
+  if (pWidget->updateDepth++ == 0) {
+    qwidget_mark_state(pWidget, QSTATE_UPDATING_BIT);
+    ++sActiveUpdates;
+  }
+}
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_end_update (
+  qwidget_t *                           pWidget
+) {
+  int err;
+  int result;
+  uint32_t idx;
+  qpending_signal_t pending;
+
+  // Only the outermost end of a nested transaction does any work.
+  if (!pWidget->updateDepth) {
+    return EINVAL;
+  }
+  if (--pWidget->updateDepth) {
+    return 0;
+  }
+  qwidget_unmark_state(pWidget, QSTATE_UPDATING_BIT);
+  --sActiveUpdates;
+
+  // Propagate the dirty state which was held back by the transaction (once).
+  if (qwidget_check_state(pWidget, QSTATE_DEFERRED_BIT)) {
+    qwidget_unmark_state(pWidget, QSTATE_DEFERRED_BIT);
+    qwidget_propagate_dirty(pWidget);
+  }
+
+  // Deliver the signals held by this transaction, in the order they were first emitted.
+  // These are removed from the middle of the queue, so leave a tombstone for the flush.
+  result = 0;
+  for (idx = 0; idx < sSignalQueue.pending.count; ++idx) {
+    pending = sSignalQueue.pending.pData[idx];
+    if (!pending.pConnection || pending.pScope != pWidget) {
+      continue;
+    }
+    sSignalQueue.pending.pData[idx].pConnection = NULL;
+    if (pending.pConnection->pendingIndex == idx + 1) {
+      pending.pConnection->pendingIndex = 0;
+    }
+    err = pending.pfnInvoke(
+      pending.pConnection,
+      sSignalQueue.payloads.pData + pending.payloadOffset
+    );
+    if (err && !result) {
+      result = err;
+    }
+  }
+
+  return result;
+}
+
 //------------------------------------------------------------------------------
 qstate_t QCURSESCALL __qwidget_mark_dirty (
   qwidget_t *                           pWidget
@@ -141,18 +746,35 @@ qstate_t QCURSESCALL __qwidget_mark_dirty (
   qwidget_mark_state(pWidget, QSTATE_DIRTY_BIT);
   newState = pWidget->internalState;
 
-  // Iteratively mark the parents recursive until we find a dirty parent.
   // This allows the update chain to know that it needs to be refreshed.
-  while ((pWidget = pWidget->pParent)) {
-    if (qwidget_check_state(pWidget, QSTATE_DIRTY_BIT)) {
-      break;
-    }
-    qwidget_mark_state(pWidget, QSTATE_DIRTY_BIT);
+  // If this widget is itself a transaction root, hold the propagation back.
+  if (qwidget_is_updating(pWidget)) {
+    qwidget_mark_state(pWidget, QSTATE_DEFERRED_BIT);
+  }
+  else {
+    qwidget_propagate_dirty(pWidget);
   }
 
   return newState;
 }
 
+// Note: The ancestors are being painted already, so the dirty state is not propagated.
+//------------------------------------------------------------------------------
+static int QCURSESCALL qwidget_repaint_visitor (
+  qwidget_t *                           pWidget,
+  void *                                pUserData
+) {
+  qwidget_mark_state(pWidget, QSTATE_DIRTY_BIT | QSTATE_REPAINT_BIT);
+  return qwidget_visit(pWidget, &qwidget_repaint_visitor, pUserData);
+}
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_mark_repaint (
+  qwidget_t *                           pWidget
+) {
+  (void)qwidget_repaint_visitor(pWidget, NULL);
+}
+
 #ifdef    __cplusplus
 }
 #endif // __cplusplus
@@ -19,16 +19,33 @@
 #include "qcurses.h"
 #include "qarray.h"
 #include "qmath.h"
+#include <string.h>
 
 #ifdef    __cplusplus
 extern "C" {
 #endif // __cplusplus
 
-// TODO: Utilize sizePolicy, minSize, maxSize - they sort of exist, but aren't used.
+////////////////////////////////////////////////////////////////////////////////
+// Widget Enumerations
+////////////////////////////////////////////////////////////////////////////////
+
+// Note: Queued and coalesced payloads are copied by value, so any pointer
+//       parameters must remain valid until the signals are flushed.
+//------------------------------------------------------------------------------
+enum qdelivery_t {
+  QDELIVERY_DIRECT,     // Invoke the slot immediately within the emit.
+  QDELIVERY_QUEUED,     // Invoke the slot once per emit at qflush_signals().
+  QDELIVERY_COALESCED   // Invoke the slot once with the latest payload at qflush_signals().
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Widget Definitions
 ////////////////////////////////////////////////////////////////////////////////
 
+// Note: Marks a widget which is not (yet) tracked by a spatial index.
+//------------------------------------------------------------------------------
+#define QSPATIAL_ENTRY_NONE UINT32_MAX
+
 //------------------------------------------------------------------------------
 #define QWIDGET_BEGIN(name)                                                     \
   typedef struct name name;                                                     \
@@ -52,6 +69,8 @@ extern "C" {
     qwidget_t * pSource;                                                        \
     qwidget_t * pTarget;                                                        \
     qsignal_t * pSignal;                                                        \
+    qdelivery_t delivery;                                                       \
+    uint32_t pendingIndex;                                                      \
     slotDecl;                                                                   \
   }
 
@@ -76,6 +95,16 @@ extern "C" {
   typedef int (QCURSESPTR *QPAINTER_NAME(name)) params;                         \
   int QCURSESCALL name qparams
 
+//------------------------------------------------------------------------------
+#define QDEFINE_VISIT(name, params, qparams)                                    \
+  typedef int (QCURSESPTR *QVISIT_NAME(name)) params;                           \
+  int QCURSESCALL name qparams
+
+//------------------------------------------------------------------------------
+#define QDEFINE_MEASURE(name, params, qparams)                                  \
+  typedef int (QCURSESPTR *QMEASURE_NAME(name)) params;                         \
+  int QCURSESCALL name qparams
+
 //------------------------------------------------------------------------------
 #define QSIGNAL(name, ...) QDEFINE_SIGNAL((qwidget_t *, __VA_ARGS__)) name
 #define QSIGNAL_VOID(name) QDEFINE_SIGNAL((qwidget_t *)) name
@@ -95,6 +124,109 @@ extern "C" {
 #define QPAINTER(name, this, ...) QDEFINE_PAINTER(name, (qwidget_t *, __VA_ARGS__), (this, __VA_ARGS__))
 #define QPAINTER_PTR(name) ((QPAINTER_NAME(name))&name)
 
+// Visits each direct child of a container widget (in painting order).
+//------------------------------------------------------------------------------
+#define QVISIT(name, this, ...) QDEFINE_VISIT(name, (qwidget_t *, __VA_ARGS__), (this, __VA_ARGS__))
+#define QVISIT_PTR(name) ((QVISIT_NAME(name))&name)
+
+// Calculates the preferred bounds of a widget, independent of any region.
+//------------------------------------------------------------------------------
+#define QMEASURE(name, this, ...) QDEFINE_MEASURE(name, (qwidget_t *, __VA_ARGS__), (this, __VA_ARGS__))
+#define QMEASURE_PTR(name) ((QMEASURE_NAME(name))&name)
+
+//------------------------------------------------------------------------------
+#define QEMITTER_NAME(name)  _##name##_emitter
+#define QINVOKER_NAME(name)  _##name##_invoker
+#define QPAYLOAD_NAME(name)  _##name##_payload_t
+#define QEMITSLOT_NAME(name) _##name##_emitslot_t
+
+//------------------------------------------------------------------------------
+#define QEMITTER_ARGC(...) QEMITTER_ARGC_(__VA_ARGS__, 4, 3, 2, 1, 0)
+#define QEMITTER_ARGC_(_1, _2, _3, _4, n, ...) n
+#define QEMITTER_CAT(a, b) QEMITTER_CAT_(a, b)
+#define QEMITTER_CAT_(a, b) a##b
+
+//------------------------------------------------------------------------------
+#define QEMITTER_FIELDS_1(a)          a _0;
+#define QEMITTER_FIELDS_2(a, b)       a _0; b _1;
+#define QEMITTER_FIELDS_3(a, b, c)    a _0; b _1; c _2;
+#define QEMITTER_FIELDS_4(a, b, c, d) a _0; b _1; c _2; d _3;
+#define QEMITTER_PARAMS_1(a)          a _0
+#define QEMITTER_PARAMS_2(a, b)       a _0, b _1
+#define QEMITTER_PARAMS_3(a, b, c)    a _0, b _1, c _2
+#define QEMITTER_PARAMS_4(a, b, c, d) a _0, b _1, c _2, d _3
+#define QEMITTER_STORE_1(p)           (p)._0 = _0
+#define QEMITTER_STORE_2(p)           QEMITTER_STORE_1(p); (p)._1 = _1
+#define QEMITTER_STORE_3(p)           QEMITTER_STORE_2(p); (p)._2 = _2
+#define QEMITTER_STORE_4(p)           QEMITTER_STORE_3(p); (p)._3 = _3
+#define QEMITTER_LOAD_1(p)            (p)._0
+#define QEMITTER_LOAD_2(p)            QEMITTER_LOAD_1(p), (p)._1
+#define QEMITTER_LOAD_3(p)            QEMITTER_LOAD_2(p), (p)._2
+#define QEMITTER_LOAD_4(p)            QEMITTER_LOAD_3(p), (p)._3
+
+// Defines the static emitter for a signal within the widget's implementation.
+// The parameter types must match the types given to the QSIGNAL declaration.
+//------------------------------------------------------------------------------
+#define QDEFINE_EMITTER(name, ...)                                              \
+  QDEFINE_EMITTER_N(name, QEMITTER_ARGC(__VA_ARGS__), __VA_ARGS__)
+#define QDEFINE_EMITTER_N(name, n, ...)                                         \
+  typedef int (QCURSESPTR *QEMITSLOT_NAME(name))(qwidget_t *, __VA_ARGS__);     \
+  typedef struct {                                                              \
+    QEMITTER_CAT(QEMITTER_FIELDS_, n)(__VA_ARGS__)                              \
+  } QPAYLOAD_NAME(name);                                                        \
+  static inline int QINVOKER_NAME(name) (                                       \
+    qconnection_t const * pConnection,                                          \
+    void const * pPayload                                                       \
+  ) {                                                                           \
+    QPAYLOAD_NAME(name) payload;                                                \
+    memcpy(&payload, pPayload, sizeof(payload));                                \
+    return ((QEMITSLOT_NAME(name))pConnection->pfnSlot)(                        \
+      pConnection->pTarget,                                                     \
+      QEMITTER_CAT(QEMITTER_LOAD_, n)(payload)                                  \
+    );                                                                          \
+  }                                                                             \
+  static inline int QEMITTER_NAME(name) (                                       \
+    qwidget_t * pSource,                                                        \
+    qsignal_t * pSignal,                                                        \
+    QEMITTER_CAT(QEMITTER_PARAMS_, n)(__VA_ARGS__)                              \
+  ) {                                                                           \
+    QPAYLOAD_NAME(name) payload;                                                \
+    QEMITTER_CAT(QEMITTER_STORE_, n)(payload);                                  \
+    return __qwidget_emit(                                                      \
+      pSource,                                                                  \
+      pSignal,                                                                  \
+      &payload,                                                                 \
+      sizeof(payload),                                                          \
+      &QINVOKER_NAME(name)                                                      \
+    );                                                                          \
+  }                                                                             \
+  static inline int QEMITTER_NAME(name) (                                       \
+    qwidget_t *,                                                                \
+    qsignal_t *,                                                                \
+    __VA_ARGS__                                                                 \
+  )
+
+//------------------------------------------------------------------------------
+#define QDEFINE_EMITTER_VOID(name)                                              \
+  typedef int (QCURSESPTR *QEMITSLOT_NAME(name))(qwidget_t *);                  \
+  static inline int QINVOKER_NAME(name) (                                       \
+    qconnection_t const * pConnection,                                          \
+    void const * pPayload                                                       \
+  ) {                                                                           \
+    (void)pPayload;                                                             \
+    return ((QEMITSLOT_NAME(name))pConnection->pfnSlot)(pConnection->pTarget);  \
+  }                                                                             \
+  static inline int QEMITTER_NAME(name) (                                       \
+    qwidget_t * pSource,                                                        \
+    qsignal_t * pSignal                                                         \
+  ) {                                                                           \
+    return __qwidget_emit(pSource, pSignal, NULL, 0, &QINVOKER_NAME(name));     \
+  }                                                                             \
+  static inline int QEMITTER_NAME(name) (                                       \
+    qwidget_t *,                                                                \
+    qsignal_t *                                                                 \
+  )
+
 //------------------------------------------------------------------------------
 #define QP(pointer) ((pointer)->pImpl)
 #define QW(pointer) ((qwidget_t *)(pointer))
@@ -104,14 +236,31 @@ extern "C" {
 ////////////////////////////////////////////////////////////////////////////////
 
 struct qconnection_t;
+typedef void (QCURSESPTR *qslot_pfn)(void);
 typedef QDEFINE_ARRAY(struct qconnection_t *)     qsignal_t;
-typedef QDEFINE_CONNECTION(void const * pfnSlot)  qconnection_t;
+typedef QDEFINE_CONNECTION(qslot_pfn pfnSlot)     qconnection_t;
 typedef QDEFINE_ARRAY(qwidget_t *)                qarray_widget_t;
 typedef QDEFINE_ARRAY(qconnection_t *)            qarray_connection_t;
 
+typedef int (QCURSESPTR *qsignal_invoke_pfn)(qconnection_t const *, void const *);
+
 typedef void (QCURSESPTR *qwidget_destroy_pfn)(qwidget_t *);
 typedef int (QCURSESPTR *qwidget_recalc_pfn)(qwidget_t *, qregion_t const *);
 typedef int (QCURSESPTR *qwidget_paint_pfn)(qwidget_t *, qpainter_t *);
+typedef int (QCURSESPTR *qwidget_visitor_pfn)(qwidget_t *, void *);
+typedef int (QCURSESPTR *qwidget_visit_pfn)(qwidget_t *, qwidget_visitor_pfn, void *);
+typedef int (QCURSESPTR *qwidget_measure_pfn)(qwidget_t *, qbounds_t *);
+typedef void (QCURSESPTR *qwidget_forget_pfn)(qwidget_t *, void *);
+
+// Note: The event is only valid during the emit, so a key should be handled directly.
+//       Set accepted to stop the key from bubbling any further towards the root.
+//------------------------------------------------------------------------------
+struct qkey_event_t {
+  qkey_t                                code;
+  qmodifier_t                           modifiers;
+  int                                   value;
+  qbool_t                               accepted;
+};
 
 //------------------------------------------------------------------------------
 struct qwidget_config_t {
@@ -121,6 +270,8 @@ struct qwidget_config_t {
   qwidget_destroy_pfn                   pfnDestroy;
   qwidget_recalc_pfn                    pfnRecalculate;
   qwidget_paint_pfn                     pfnPaint;
+  qwidget_visit_pfn                     pfnVisit;       // NULL for widgets without children.
+  qwidget_measure_pfn                   pfnMeasure;     // NULL to prefer the minimum bounds.
 };
 
 //------------------------------------------------------------------------------
@@ -128,16 +279,30 @@ struct qwidget_t {
   qalloc_t const *                      pAllocator;
   qwidget_t *                           pParent;
   qstate_t                              internalState;
+  uint32_t                              updateDepth;    // Nesting count of qwidget_begin_update().
   qarray_connection_t                   connections;
-  qpolicy_t                             sizePolicy;
+  qpolicy_t                             sizePolicy;     // Applied along the axis of the owning layout.
   qbounds_t                             minimumBounds;  // Minimum allowed bounds.
   qbounds_t                             maximumBounds;  // Maximum allowed bounds.
+  qbounds_t                             sizeHint;       // Cached preferred bounds (limited by min/max).
   qbounds_t                             contentBounds;  // Calculated content bounds (not always limited by min/max).
   qregion_t                             innerRegion;    // The total region that contains content.
   qregion_t                             outerRegion;    // The total region that the widget paints to.
+  qcoord_t                              scrollOffset;   // How far the children are scrolled (painted at region - offset).
   qwidget_destroy_pfn                   pfnDestroy;
   qwidget_recalc_pfn                    pfnRecalculate;
   qwidget_paint_pfn                     pfnPaint;
+  qwidget_visit_pfn                     pfnVisit;
+  qwidget_measure_pfn                   pfnMeasure;
+  uint32_t                              spatialEntry;   // Entry within the application's spatial index.
+  qwidget_t *                           pFocusNext;     // Tab order ring (owned by the application).
+  qwidget_t *                           pFocusPrevious;
+  QWIDGET_SIGNALS_BEGIN
+    QSIGNAL(on_mouse, qcoord_t const * coord, qmouse_t state);
+    QSIGNAL(on_hover, qbool_t entered);
+    QSIGNAL(on_key_press, qkey_event_t * event);
+    QSIGNAL(on_focus, qbool_t focused);
+  QWIDGET_SIGNALS_END
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -198,20 +363,113 @@ static inline int QCURSESCALL __qwidget_paint (
     pPainter                                                                    \
   )
 
+//------------------------------------------------------------------------------
+static inline int QCURSESCALL __qwidget_visit (
+  qwidget_t *                           pWidget,
+  qwidget_visitor_pfn                   pfnVisitor,
+  void *                                pUserData
+) {
+  if (!pWidget->pfnVisit) {
+    return 0;
+  }
+  return pWidget->pfnVisit(pWidget, pfnVisitor, pUserData);
+}
+
+// Calls pfnVisitor for each direct child, stopping at the first non-zero result.
+//------------------------------------------------------------------------------
+#define qwidget_visit(pWidget, pfnVisitor, pUserData)                           \
+  __qwidget_visit(                                                              \
+    (qwidget_t *)(pWidget),                                                     \
+    pfnVisitor,                                                                 \
+    pUserData                                                                   \
+  )
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_size_hint (
+  qwidget_t *                           pWidget,
+  qbounds_t *                           pHint
+);
+
+// Returns the preferred bounds, only measuring again after qwidget_update_geometry().
+//------------------------------------------------------------------------------
+#define qwidget_size_hint(pWidget, pHint)                                       \
+  __qwidget_size_hint(                                                          \
+    (qwidget_t *)(pWidget),                                                     \
+    pHint                                                                       \
+  )
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_update_geometry (
+  qwidget_t *                           pWidget
+);
+
+// Call this when the content of a widget changes its preferred bounds.
+// Invalidates the cached size hints up to the root, and marks the widget dirty.
+//------------------------------------------------------------------------------
+#define qwidget_update_geometry(pWidget)                                        \
+  __qwidget_update_geometry(                                                    \
+    (qwidget_t *)(pWidget)                                                      \
+  )
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_size_policy (
+  qwidget_t *                           pWidget,
+  qpolicy_t                             policy
+);
+
+//------------------------------------------------------------------------------
+#define qwidget_set_size_policy(pWidget, policy)                                \
+  __qwidget_set_size_policy(                                                    \
+    (qwidget_t *)(pWidget),                                                     \
+    policy                                                                      \
+  )
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_minimum_bounds (
+  qwidget_t *                           pWidget,
+  qbounds_t const *                     pBounds
+);
+
+//------------------------------------------------------------------------------
+#define qwidget_set_minimum_bounds(pWidget, pBounds)                            \
+  __qwidget_set_minimum_bounds(                                                 \
+    (qwidget_t *)(pWidget),                                                     \
+    pBounds                                                                     \
+  )
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_maximum_bounds (
+  qwidget_t *                           pWidget,
+  qbounds_t const *                     pBounds
+);
+
+//------------------------------------------------------------------------------
+#define qwidget_set_maximum_bounds(pWidget, pBounds)                            \
+  __qwidget_set_maximum_bounds(                                                 \
+    (qwidget_t *)(pWidget),                                                     \
+    pBounds                                                                     \
+  )
+
 //------------------------------------------------------------------------------
 int QCURSESCALL __qwidget_prepare_connection (
   qwidget_t *                           pSource,
   qwidget_t *                           pTarget,
-  qsignal_t *                           pSignal
+  qsignal_t *                           pSignal,
+  qdelivery_t                           delivery
 );
 
 //------------------------------------------------------------------------------
 #define qwidget_connect(pSource, signal, pTarget, slot)                         \
+  qwidget_connect_delivery(pSource, signal, pTarget, slot, QDELIVERY_DIRECT)
+
+//------------------------------------------------------------------------------
+#define qwidget_connect_delivery(pSource, signal, pTarget, slot, delivery)      \
   (                                                                             \
     __qwidget_prepare_connection(                                               \
       (qwidget_t *)(pSource),                                                   \
       (qwidget_t *)(pTarget),                                                   \
-      (qsignal_t *)&(pSource)->signals.signal                                   \
+      (qsignal_t *)&(pSource)->signals.signal,                                  \
+      delivery                                                                  \
     ) ||                                                                        \
     !((pSource)->signals.signal.pData[                                          \
       (pSource)->signals.signal.count - 1                                       \
@@ -223,6 +481,20 @@ int QCURSESCALL __qwidget_prepare_connection (
     ) ? ERANGE : ENOMEM                                                         \
   ) : 0
 
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_disconnect (
+  qwidget_t *                           pSource,
+  qwidget_t *                           pTarget
+);
+
+// Removes every connection from the source to the target, along with any pending deliveries.
+//------------------------------------------------------------------------------
+#define qwidget_disconnect(pSource, pTarget)                                    \
+  __qwidget_disconnect(                                                         \
+    (qwidget_t *)(pSource),                                                     \
+    (qwidget_t *)(pTarget)                                                      \
+  )
+
 //------------------------------------------------------------------------------
 #define qwidget_mark_state(pWidget, state)                                      \
   ((((qwidget_t *)(pWidget)))->internalState |= (state))
@@ -256,20 +528,27 @@ int QCURSESCALL __qwidget_prepare_connection (
   qwidget_check_state(pWidget, QSTATE_VISIBLE_BIT)
 
 //------------------------------------------------------------------------------
-#define qwidget_mark_visible(pWidget)                                           \
-  qwidget_mark_state(pWidget, QSTATE_VISIBLE_BIT)
+void QCURSESCALL __qwidget_set_visible (
+  qwidget_t *                           pWidget,
+  qbool_t                               visible
+);
 
+// Showing or hiding a widget changes the tree as seen by the tab order and the spatial index.
 //------------------------------------------------------------------------------
-#define qwidget_unmark_visible(pWidget)                                         \
-  qwidget_unmark_state(pWidget, QSTATE_VISIBLE_BIT)
+#define qwidget_set_visible(pWidget, boolean)                                   \
+  __qwidget_set_visible((qwidget_t *)(pWidget), boolean)
 
 //------------------------------------------------------------------------------
-#define qwidget_set_visible(pWidget, boolean)                                   \
-  qwidget_set_state(pWidget, QSTATE_VISIBLE_BIT, boolean)
+#define qwidget_mark_visible(pWidget)                                           \
+  qwidget_set_visible(pWidget, QTRUE)
+
+//------------------------------------------------------------------------------
+#define qwidget_unmark_visible(pWidget)                                         \
+  qwidget_set_visible(pWidget, QFALSE)
 
 //------------------------------------------------------------------------------
 #define qwidget_toggle_visible(pWidget)                                         \
-  qwidget_toggle_state(pWidget, QSTATE_VISIBLE_BIT)
+  qwidget_set_visible(pWidget, !qwidget_is_visible(pWidget))
 
 //------------------------------------------------------------------------------
 #define qwidget_is_dirty(pWidget)                                               \
@@ -284,9 +563,25 @@ qstate_t QCURSESCALL __qwidget_mark_dirty (
 #define qwidget_mark_dirty(pWidget)                                             \
   __qwidget_mark_dirty((qwidget_t *)pWidget)
 
+// Marks the widget and everything inside it to be painted in full, for a parent which cleared them.
+// Note: Widgets which only paint what changed must check for QSTATE_REPAINT_BIT before relying on the screen.
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_mark_repaint (
+  qwidget_t *                           pWidget
+);
+
+//------------------------------------------------------------------------------
+#define qwidget_mark_repaint(pWidget)                                           \
+  __qwidget_mark_repaint((qwidget_t *)pWidget)
+
+//------------------------------------------------------------------------------
+#define qwidget_needs_repaint(pWidget)                                          \
+  qwidget_check_state(pWidget, QSTATE_REPAINT_BIT)
+
+// Note: Once painted, a widget no longer needs to be painted in full either.
 //------------------------------------------------------------------------------
 #define qwidget_unmark_dirty(pWidget)                                           \
-  qwidget_unmark_state(pWidget, QSTATE_DIRTY_BIT)
+  qwidget_unmark_state(pWidget, QSTATE_DIRTY_BIT | QSTATE_REPAINT_BIT)
 
 //------------------------------------------------------------------------------
 #define qwidget_set_dirty(pWidget, boolean)                                     \
@@ -296,19 +591,165 @@ qstate_t QCURSESCALL __qwidget_mark_dirty (
 #define qwidget_toggle_dirty(pWidget)                                           \
   qwidget_toggle_state(pWidget, QSTATE_DIRTY_BIT)
 
+//------------------------------------------------------------------------------
+#define qwidget_is_updating(pWidget)                                            \
+  qwidget_check_state(pWidget, QSTATE_UPDATING_BIT)
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_begin_update (
+  qwidget_t *                           pWidget
+);
+
+// Suspends dirty propagation and direct signal delivery for the widget's subtree.
+// Transactions may nest, only the outermost qwidget_end_update() flushes.
+//------------------------------------------------------------------------------
+#define qwidget_begin_update(pWidget)                                           \
+  __qwidget_begin_update((qwidget_t *)(pWidget))
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_end_update (
+  qwidget_t *                           pWidget
+);
+
+// Propagates the dirty state once, then delivers the coalesced direct signals.
+// Returns the first error reported by any of the delivered slots.
+//------------------------------------------------------------------------------
+#define qwidget_end_update(pWidget)                                             \
+  __qwidget_end_update((qwidget_t *)(pWidget))
+
+//------------------------------------------------------------------------------
+#define qwidget_is_focusable(pWidget)                                           \
+  qwidget_check_state(pWidget, QSTATE_FOCUSABLE_BIT)
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_focusable (
+  qwidget_t *                           pWidget,
+  qbool_t                               focusable
+);
+
+// Adds or removes the widget from the tab order (which is rebuilt on demand).
+//------------------------------------------------------------------------------
+#define qwidget_set_focusable(pWidget, boolean)                                 \
+  __qwidget_set_focusable((qwidget_t *)(pWidget), boolean)
+
+//------------------------------------------------------------------------------
+#define qwidget_has_focus(pWidget)                                              \
+  qwidget_check_state(pWidget, QSTATE_FOCUSED_BIT)
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_set_parent (
+  qwidget_t *                           pWidget,
+  qwidget_t *                           pParent
+);
+
+// Containers must attach their children with this, so structural changes are seen.
+//------------------------------------------------------------------------------
+#define qwidget_set_parent(pWidget, pParent)                                    \
+  __qwidget_set_parent((qwidget_t *)(pWidget), (qwidget_t *)(pParent))
+
+// Returns a counter which changes whenever a parent or the focusable state changes.
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qwidget_tree_generation (void);
+
+// Call this when a container reorders its children, so derived orderings are rebuilt.
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_bump_tree_generation (void);
+
+// Sets the function called with every widget being destroyed (before it is), so references to it can be dropped.
+// Note: There is only one, which the application uses for its focus, hover and spatial index. NULL removes it.
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_set_forget_hook (
+  qwidget_forget_pfn                    pfnForget,
+  void *                                pUserData
+);
+
 //------------------------------------------------------------------------------
 #define qwidget_check(pWidget)                                                  \
   ((pWidget) && qwidget_is_visible(pWidget))
 
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_emit (
+  qwidget_t *                           pSource,
+  qsignal_t *                           pSignal,
+  void const *                          pPayload,
+  size_t                                payloadSize,
+  qsignal_invoke_pfn                    pfnInvoke
+);
+
+// Note: All connected slots are invoked even if one of them fails.
+//       The result is the first error reported by any of the slots.
 //------------------------------------------------------------------------------
 #define qwidget_emit(pWidget, signal, ...)                                      \
-  for (uint32_t __idx = 0; __idx < (pWidget)->signals.signal.count; ++__idx) {  \
-    int __result = (pWidget)->signals.signal.pData[__idx]->pfnSlot(             \
-      (pWidget)->signals.signal.pData[__idx]->pTarget,                          \
+  (                                                                             \
+    (void)sizeof(                                                               \
+      (pWidget)->signals.signal.pData[0]->pfnSlot ==                            \
+      (QEMITSLOT_NAME(signal))0                                                 \
+    ),                                                                          \
+    QEMITTER_NAME(signal)(                                                      \
+      (qwidget_t *)(pWidget),                                                   \
+      (qsignal_t *)&(pWidget)->signals.signal,                                  \
       __VA_ARGS__                                                               \
-    );                                                                          \
-    if (__result) return __result;                                              \
-  }
+    )                                                                           \
+  )
+
+//------------------------------------------------------------------------------
+#define qwidget_emit_void(pWidget, signal)                                      \
+  (                                                                             \
+    (void)sizeof(                                                               \
+      (pWidget)->signals.signal.pData[0]->pfnSlot ==                            \
+      (QEMITSLOT_NAME(signal))0                                                 \
+    ),                                                                          \
+    QEMITTER_NAME(signal)(                                                      \
+      (qwidget_t *)(pWidget),                                                   \
+      (qsignal_t *)&(pWidget)->signals.signal                                   \
+    )                                                                           \
+  )
+
+// Delivers all queued and coalesced signals in the order they were first emitted.
+// The application calls this once per input batch, before recalculating and painting.
+//------------------------------------------------------------------------------
+int QCURSESCALL qflush_signals (void);
+
+// Frees the shared signal queue, any signals which are still pending are dropped.
+// Note: The application calls this when it is destroyed, the queue is allocated again on the next emit.
+//------------------------------------------------------------------------------
+void QCURSESCALL qteardown_signals (void);
+
+//------------------------------------------------------------------------------
+int QCURSESCALL __qwidget_post_update (
+  qwidget_t *                           pWidget
+);
+
+// Thread-safe, the widget is marked dirty by the application at its next update.
+// Note: This is how work done by other threads asks to be recalculated and painted.
+//------------------------------------------------------------------------------
+#define qwidget_post_update(pWidget)                                            \
+  __qwidget_post_update((qwidget_t *)(pWidget))
+
+//------------------------------------------------------------------------------
+void QCURSESCALL __qwidget_drop_posted_updates (
+  qwidget_t *                           pWidget
+);
+
+// Widgets which post updates must call this when destroyed (after their threads stopped).
+//------------------------------------------------------------------------------
+#define qwidget_drop_posted_updates(pWidget)                                    \
+  __qwidget_drop_posted_updates((qwidget_t *)(pWidget))
+
+// Marks the posted widgets dirty, the application calls this on each update.
+//------------------------------------------------------------------------------
+void QCURSESCALL qflush_posted_updates (void);
+
+// Background work which will post an update, while any is running the application polls.
+// Note: These are only called by the UI thread, when work is started and when its result is used.
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_begin_background (void);
+
+//------------------------------------------------------------------------------
+void QCURSESCALL qwidget_end_background (void);
+
+//------------------------------------------------------------------------------
+uint32_t QCURSESCALL qwidget_background_count (void);
 
 #ifdef    __cplusplus
 }
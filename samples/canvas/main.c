@@ -103,6 +103,7 @@ QPAINTER(
 ) {
   int finalValue;
   size_t idxOffset;
+  qcoord_t paintCoord;
 
   // If the dirty coordinate is the same as the previous coordinate
   // then there is nothing to update (we don't update the same cell twice).
@@ -112,8 +113,8 @@ QPAINTER(
 
   // Calculate the index into the canvas buffer, and add the brush value.
   // This value should be clamped to the min/max canvas value as well.
-  idxOffset  = QW(pThis)->contentBounds.columns * QP(pThis)->currCoord.row;
-  idxOffset += QP(pThis)->currCoord.column;
+  idxOffset  = (size_t)QW(pThis)->contentBounds.columns * (size_t)QP(pThis)->currCoord.row;
+  idxOffset += (size_t)QP(pThis)->currCoord.column;
   QP(pThis)->pBuffer[idxOffset] += QP(pThis)->brushValue;
   if (QP(pThis)->pBuffer[idxOffset] > CANVAS_MAX_VALUE) {
     QP(pThis)->pBuffer[idxOffset] = CANVAS_MAX_VALUE;
@@ -123,11 +124,16 @@ QPAINTER(
   }
 
   // Update the character on-screen which has been updated by the logic.
+  // The brush coordinate is local to the canvas, so offset it onto the screen.
   QP(pThis)->prevCoord = QP(pThis)->currCoord;
   finalValue = (int)(QP(pThis)->pBuffer[idxOffset]);
+  paintCoord = qcoord(
+    QW(pThis)->outerRegion.coord.column + QP(pThis)->currCoord.column,
+    QW(pThis)->outerRegion.coord.row    + QP(pThis)->currCoord.row
+  );
   return qpainter_paint(
     pPainter,
-    &QP(pThis)->currCoord,
+    &paintCoord,
     &s_brushweights[finalValue],
     1
   );
@@ -188,7 +194,7 @@ static void qdestroy_canvas (
   canvas_widget_t *                     canvas
 ) {
   free(QP(canvas)->pBuffer);
-  qdestroy_widget(canvas);
+  qfree(QW(canvas)->pAllocator, canvas);
 }
 
 //------------------------------------------------------------------------------
@@ -207,6 +213,8 @@ static int create_canvas_widget (
   widgetConfig.pfnDestroy     = QDESTROY_PTR(qdestroy_canvas);
   widgetConfig.pfnRecalculate = QRECALC_PTR(canvas_widget_recalculate);
   widgetConfig.pfnPaint       = QPAINTER_PTR(canvas_widget_paint);
+  widgetConfig.pfnVisit       = NULL;
+  widgetConfig.pfnMeasure     = NULL;
 
   // Allocate the terminal UI application.
   err = qcreate_widget(
@@ -233,7 +241,7 @@ static int main_prepare_main_widget (
 ) {
   canvas_widget_t * canvas;
   QCHECK(create_canvas_widget(pAllocator, &canvas));
-  QCHECK(qwidget_connect(pApplication, on_mouse, canvas, canvas_widget_click));
+  QCHECK(qwidget_connect(QW(canvas), on_mouse, canvas, canvas_widget_click));
   QCHECK(qapplication_set_main_widget(pApplication, canvas));
   return 0;
 }
@@ -33,51 +33,56 @@
 
 #define QCHECK(s) do { int err = s; if (err) return err; } while (0)
 
+// Quit chord (Ctrl+X, C), alongside the "Q" shortcut.
+// Note: The terminal is not in raw mode, so Ctrl+C raises SIGINT instead of
+//       arriving as a keystroke; the chord must end on a key that is delivered.
+static qkeystroke_t const s_quitChord[] = {
+  { QKEY_X, QMODIFIER_CONTROL_BIT },
+  { QKEY_C, QMODIFIER_NONE }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // Application Callbacks
 ////////////////////////////////////////////////////////////////////////////////
 
 //------------------------------------------------------------------------------
-QSLOT(
+QSLOT_VOID(
   application_quit,
-  qapplication_t *                      pThis,
-  qkey_t                                code,
-  int                                   value
+  qapplication_t *                      pThis
 ) {
-  (void)value;
-
-  // If the user presses "Q", we should prepare to quit.
-  if (code == QKEY_Q) {
-    return qapplication_quit(pThis, 0);
-  }
+  return qapplication_quit(pThis, 0);
+}
 
-  return 0;
+//------------------------------------------------------------------------------
+QSLOT_VOID(
+  layout_vertical,
+  qlayout_t *                           pThis
+) {
+  return qlayout_set_format(pThis, QLAYOUT_VERTICAL);
 }
 
 //------------------------------------------------------------------------------
-QSLOT(
-  layout_reorganize,
-  qlayout_t *                           pThis,
-  qkey_t                                code,
-  int                                   value
+QSLOT_VOID(
+  layout_vertical_reverse,
+  qlayout_t *                           pThis
 ) {
-  (void)value;
+  return qlayout_set_format(pThis, QLAYOUT_VERTICAL_REVERSE);
+}
 
-  // If the user presses "Q", we should prepare to quit.
-  if (code == QKEY_1) {
-    return qlayout_set_format(pThis, QLAYOUT_VERTICAL);
-  }
-  if (code == QKEY_2) {
-    return qlayout_set_format(pThis, QLAYOUT_VERTICAL_REVERSE);
-  }
-  if (code == QKEY_3) {
-    return qlayout_set_format(pThis, QLAYOUT_HORIZONTAL);
-  }
-  if (code == QKEY_4) {
-    return qlayout_set_format(pThis, QLAYOUT_HORIZONTAL_REVERSE);
-  }
+//------------------------------------------------------------------------------
+QSLOT_VOID(
+  layout_horizontal,
+  qlayout_t *                           pThis
+) {
+  return qlayout_set_format(pThis, QLAYOUT_HORIZONTAL);
+}
 
-  return 0;
+//------------------------------------------------------------------------------
+QSLOT_VOID(
+  layout_horizontal_reverse,
+  qlayout_t *                           pThis
+) {
+  return qlayout_set_format(pThis, QLAYOUT_HORIZONTAL_REVERSE);
 }
 
 //------------------------------------------------------------------------------
@@ -116,13 +121,18 @@ static int main_prepare_main_widget (
   qlabel_t * label;
   qlayout_t * layout;
   QCHECK(qcreate_layout(pAllocator, QLAYOUT_VERTICAL, &layout));
-  QCHECK(qwidget_connect(pApplication, on_key, layout, layout_reorganize));
+  QCHECK(qapplication_add_shortcut_key(pApplication, layout, QKEY_1, QMODIFIER_NONE, layout, layout_vertical));
+  QCHECK(qapplication_add_shortcut_key(pApplication, layout, QKEY_2, QMODIFIER_NONE, layout, layout_vertical_reverse));
+  QCHECK(qapplication_add_shortcut_key(pApplication, layout, QKEY_3, QMODIFIER_NONE, layout, layout_horizontal));
+  QCHECK(qapplication_add_shortcut_key(pApplication, layout, QKEY_4, QMODIFIER_NONE, layout, layout_horizontal_reverse));
+  qwidget_set_focusable(layout, QTRUE);
   main_create_attach_label_k(pAllocator, layout, "This");
   main_create_attach_label_k(pAllocator, layout, "ia a");
   main_create_attach_label_k(pAllocator, layout, "Vertical");
   QCHECK(qwidget_connect(layout, set_format, label, layout_changed));
   main_create_attach_label_k(pAllocator, layout, "Layout");
   QCHECK(qapplication_set_main_widget(pApplication, layout));
+  QCHECK(qapplication_set_focus(pApplication, layout));
   return 0;
 }
 
@@ -132,7 +142,9 @@ static int main_prepare_application (
   qapplication_t *                      pApplication
 ) {
   (void)pAllocator;
-  QCHECK(qwidget_connect(pApplication, on_key, pApplication, application_quit));
+  QCHECK(qapplication_add_shortcut_key(pApplication, NULL, QKEY_Q, QMODIFIER_NONE, pApplication, application_quit));
+  QCHECK(qapplication_add_shortcut_key(pApplication, NULL, QKEY_Q, QMODIFIER_SHIFT_BIT, pApplication, application_quit));
+  QCHECK(qapplication_add_shortcut(pApplication, NULL, s_quitChord, 2, pApplication, application_quit));
   QCHECK(main_prepare_main_widget(pAllocator, pApplication));
   return 0;
 }